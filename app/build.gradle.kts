@@ -29,6 +29,11 @@ android {
 			ndk {
 				abiFilters += "arm64-v8a"
 			}
+			externalNativeBuild {
+				cmake {
+					arguments += "-DYUBINOBUTAI_REALTIME_SAFETY_CHECK=ON"
+				}
+			}
 		}
 		release {
 			isMinifyEnabled = false
@@ -45,6 +50,10 @@ android {
 	buildFeatures {
 		prefab = true
 	}
+	androidResources {
+		// Binary charts are mapped straight from the APK, which only works for uncompressed assets.
+		noCompress += "ybc"
+	}
 	externalNativeBuild {
 		cmake {
 			path = file("src/main/cpp/CMakeLists.txt")
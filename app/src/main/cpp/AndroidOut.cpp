@@ -1,4 +1,10 @@
 #include "AndroidOut.h"
 
+#ifdef __ANDROID__
 AndroidOut androidOut("YubiNoButai");
-std::ostream aout(&androidOut);
\ No newline at end of file
+std::ostream aout(&androidOut);
+#else
+#include <iostream>
+
+std::ostream aout(std::cerr.rdbuf());
+#endif
\ No newline at end of file
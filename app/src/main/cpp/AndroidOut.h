@@ -1,11 +1,16 @@
 #ifndef YUBINOBUTAI_ANDROIDOUT_H
 #define YUBINOBUTAI_ANDROIDOUT_H
 
-#include <android/log.h>
 #include <sstream>
 
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+// Logcat on Android. Tools built for the desktop get standard error instead.
 extern std::ostream aout;
 
+#ifdef __ANDROID__
 class AndroidOut: public std::stringbuf {
 	private:
 		const char* logTag_;
@@ -18,5 +23,6 @@ class AndroidOut: public std::stringbuf {
 	public:
 		AndroidOut(const char* kLogTag): logTag_(kLogTag) {}
 };
+#endif
 
 #endif // YUBINOBUTAI_ANDROIDOUT_H
\ No newline at end of file
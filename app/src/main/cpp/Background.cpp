@@ -0,0 +1,67 @@
+#include <string>
+#include <utility>
+
+#include <GLES3/gl3.h>
+
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "TextureLoader.h"
+
+#include "Background.h"
+
+namespace {
+
+const std::string vertexShader = R"vertex(#version 300 es
+uniform vec2 uScale;
+out vec2 fragUv;
+
+void main() {
+	// One triangle covering the screen.
+	vec2 position = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);
+	gl_Position = vec4(position, 0.0, 1.0);
+	// The image's first row is at the top.
+	fragUv = vec2(position.x, -position.y) * uScale * 0.5 + 0.5;
+}
+)vertex";
+
+const std::string fragmentShader = R"fragment(#version 300 es
+precision mediump float;
+uniform sampler2D uTexture;
+in vec2 fragUv;
+out vec4 outColor;
+
+void main() {
+	outColor = texture(uTexture, fragUv);
+}
+)fragment";
+
+} // namespace
+
+Background::Background(TextureLoader &textureLoader, const std::string &assetPath):
+	shader(std::move(Shader::loadShader("Background", vertexShader, fragmentShader))),
+	texture(textureLoader.load(assetPath))
+{
+	uScale = glGetUniformLocation(shader->getProgram(), "uScale");
+	glGenVertexArrays(1, &vertexArray);
+}
+
+Background::~Background() {
+	glDeleteVertexArrays(1, &vertexArray);
+}
+
+void Background::render(RenderQueue &queue, const int screenWidth, const int screenHeight) const {
+	// The placeholder is transparent, so drawing it costs a pass over the screen but shows nothing.
+	float scale[2] = {1.f, 1.f};
+	if (texture->isResident() && screenHeight != 0) {
+		const float
+			screenAspect = static_cast<float>(screenWidth) / screenHeight,
+			imageAspect = static_cast<float>(texture->getWidth()) / texture->getHeight();
+		// The side that sticks out is cropped evenly.
+		if (screenAspect > imageAspect) scale[1] = imageAspect / screenAspect;
+		else scale[0] = screenAspect / imageAspect;
+	}
+	queue.add(
+		RenderQueue::Pass::Background, 0.f, shader->getProgram(), vertexArray, texture->getTextureId(),
+		{{uScale, GlStateCache::UniformType::Vector2, scale}}, 0, {}, {GL_TRIANGLES, 3}
+	);
+}
\ No newline at end of file
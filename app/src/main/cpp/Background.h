@@ -0,0 +1,31 @@
+#ifndef YUBINOBUTAI_BACKGROUND_H
+#define YUBINOBUTAI_BACKGROUND_H
+
+#include <memory>
+#include <string>
+
+#include <GLES3/gl3.h>
+
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "TextureLoader.h"
+
+// A picture filling the screen behind everything else, cropped to keep its aspect ratio. It is streamed in, so
+// nothing shows for the first frames or if the asset is missing.
+class Background final {
+	private:
+		std::unique_ptr<Shader> shader;
+		GLint uScale;
+		// Nothing to read from, but drawing still needs a vertex array bound.
+		GLuint vertexArray = 0;
+		TextureLoader::Handle texture;
+	public:
+		Background(TextureLoader &textureLoader, const std::string &assetPath);
+		Background(const Background&) = delete;
+		Background& operator=(const Background&) = delete;
+		~Background();
+		// On the GL thread, since the texture turns resident there.
+		void render(RenderQueue &queue, int screenWidth, int screenHeight) const;
+};
+
+#endif // YUBINOBUTAI_BACKGROUND_H
\ No newline at end of file
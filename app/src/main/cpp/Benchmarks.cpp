@@ -0,0 +1,164 @@
+#ifdef YUBINOBUTAI_BENCHMARKS
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <GLES3/gl3.h>
+#include <android/asset_manager.h>
+#include <glm/ext.hpp>
+#include <glm/glm.hpp>
+
+#include <audio/PreloadedAudioTrack.h>
+#include "AndroidOut.h"
+#include "Chart.h"
+#include "LineBatch.h"
+#include "RenderQueue.h"
+#include "StreamingBuffer.h"
+#include "TestLine.h"
+#include "TextureAsset.h"
+
+#include "Benchmarks.h"
+
+namespace {
+	constexpr int audioLoadingRuns = 50;
+	constexpr int chartLoadingRuns = 20;
+	constexpr int lineRenderingRuns = 50;
+	constexpr int textureLoadingRuns = 10;
+	// About what a dense stretch of chart puts on screen.
+	constexpr int lineCount = 1000;
+
+	template<typename Function>
+	double timeRuns(const int runs, const Function &function) {
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i != runs; ++i) function();
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / runs;
+	}
+
+	// Only the time spent issuing the commands. The GPU is drained between runs so one doesn't stall the next.
+	template<typename Function>
+	double timeSubmission(const int runs, const Function &function) {
+		double total = 0.;
+		for (int i = 0; i != runs; ++i) {
+			glFinish();
+			total += timeRuns(1, function);
+		}
+		glFinish();
+		return total / runs;
+	}
+
+	// Reports the average time to a finished upload and the memory taken, or nothing if the file can't be used.
+	template<typename Load>
+	void timeTextureLoading(const char *const description, const Load &load) {
+		const auto texture = load();
+		if (!texture) return;
+		const double time = timeRuns(textureLoadingRuns, [&]() {
+			load();
+			glFinish();
+		});
+		aout << "  " << description << ": " << time / 1000. << " ms, " << texture->getByteSize() / 1024 << " KiB"
+			<< std::endl;
+	}
+
+	double timeAudioLoading(AAssetManager *const assetManager, const std::string &name, const bool alwaysUseDecoder) {
+		return timeRuns(audioLoadingRuns, [&]() {
+			PreloadedAudioTrack track(assetManager, name, alwaysUseDecoder);
+		});
+	}
+} // namespace
+
+void Benchmarks::runAudioLoading(AAssetManager *const assetManager) {
+	const std::string name = "Hit.wav";
+	// Warm up the asset cache so both paths read from memory.
+	timeAudioLoading(assetManager, name, true);
+	aout << "Loading " << name << ": " << timeAudioLoading(assetManager, name, false) << " µs direct, "
+		<< timeAudioLoading(assetManager, name, true) << " µs through FFmpeg" << std::endl;
+}
+
+void Benchmarks::runChartLoading(AAssetManager *const assetManager) {
+	const std::unique_ptr<AAsset, void(*)(AAsset*)> textAsset(
+		AAssetManager_open(assetManager, "chart.txt", AASSET_MODE_BUFFER), AAsset_close
+	);
+	if (textAsset == nullptr) return;
+	const char *const text = static_cast<const char*>(AAsset_getBuffer(textAsset.get()));
+	const auto textSize = static_cast<std::size_t>(AAsset_getLength64(textAsset.get()));
+
+	struct TextNote {
+		int time, position;
+	};
+	// The original loader.
+	const double streamTime = timeRuns(chartLoadingRuns, [&]() {
+		std::vector<TextNote> notes;
+		std::istringstream stream(std::string(text, textSize));
+		while (true) {
+			TextNote note;
+			stream >> note.time;
+			if (!stream) break;
+			stream >> note.position;
+			notes.push_back(note);
+		}
+	});
+	const double conversionTime = timeRuns(chartLoadingRuns, [&]() {
+		std::vector<unsigned char> data;
+		Chart::convertText(text, textSize, data);
+	});
+	aout << "Loading chart.txt: " << streamTime << " µs with streams, " << conversionTime
+		<< " µs converting to binary" << std::endl;
+	if (!Chart::fromAsset(assetManager, "chart.ybc")) return;
+	const double binaryTime = timeRuns(chartLoadingRuns, [&]() {
+		Chart::fromAsset(assetManager, "chart.ybc");
+	});
+	aout << "Loading chart.ybc: " << binaryTime << " µs" << std::endl;
+}
+
+void Benchmarks::runTextureLoading(AAssetManager *const assetManager) {
+	const std::string name = "background";
+	const std::unique_ptr<AAsset, void(*)(AAsset*)> image(
+		AAssetManager_open(assetManager, (name + ".png").c_str(), AASSET_MODE_BUFFER), AAsset_close
+	);
+	if (image == nullptr) return;
+	aout << "Loading " << name << ":" << std::endl;
+	timeTextureLoading("PNG", [&]() {
+		const auto image = TextureAsset::decodeImage(assetManager, name + ".png");
+		return image ? TextureAsset::upload(*image) : nullptr;
+	});
+	timeTextureLoading("ASTC", [&]() {
+		const auto image = TextureAsset::decodeCompressed(assetManager, name + ".astc.ktx2");
+		return image ? TextureAsset::upload(*image) : nullptr;
+	});
+	timeTextureLoading("ETC2", [&]() {
+		const auto image = TextureAsset::decodeCompressed(assetManager, name + ".etc2.ktx2");
+		return image ? TextureAsset::upload(*image) : nullptr;
+	});
+}
+
+void Benchmarks::runLineRendering(StreamingBuffer &streamingBuffer) {
+	const TestLine testLine(streamingBuffer);
+	LineBatch lineBatch(streamingBuffer);
+	RenderQueue renderQueue;
+	const auto camera = glm::translate(
+		glm::perspectiveFov<float>(glm::radians(70.f), 1080.f, 2400.f, 0.01f, 1000.f), glm::vec3(0.f, -4.f, -7.f)
+	);
+	const auto getPosition = [](const int index) {
+		return glm::vec3(index % 10 / 2.f - 2.25f, 0.f, index * -0.5f);
+	};
+	const double separateTime = timeSubmission(lineRenderingRuns, [&]() {
+		for (int i = 0; i != lineCount; ++i)
+			testLine.render(glm::translate(camera, getPosition(i)), 1.5f, 0.5f, {1.f, 1.f, 0.f, 1.f});
+		streamingBuffer.endFrame();
+	});
+	const double batchedTime = timeSubmission(lineRenderingRuns, [&]() {
+		for (int i = 0; i != lineCount; ++i) lineBatch.add(getPosition(i), 1.5f, 0.5f, {1.f, 1.f, 0.f, 1.f});
+		lineBatch.render(renderQueue, RenderQueue::Pass::Scene, camera);
+		renderQueue.submit();
+		streamingBuffer.endFrame();
+	});
+	glClear(GL_COLOR_BUFFER_BIT);
+	aout << "Drawing " << lineCount << " lines: " << separateTime << " µs in " << lineCount << " draw calls, "
+		<< batchedTime << " µs in 1 instanced draw call" << std::endl;
+}
+
+#endif // YUBINOBUTAI_BENCHMARKS
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef YUBINOBUTAI_BENCHMARKS_H
+#define YUBINOBUTAI_BENCHMARKS_H
+
+#include <android/asset_manager.h>
+
+#include "StreamingBuffer.h"
+
+// Timing runs for the loading and rendering paths, only built with `YUBINOBUTAI_BENCHMARKS`. Results go to the log.
+namespace Benchmarks {
+	void runAudioLoading(AAssetManager *assetManager);
+	void runChartLoading(AAssetManager *assetManager);
+	// Needs a current GL context.
+	void runTextureLoading(AAssetManager *assetManager);
+	// Needs a current GL context. Draws into the back buffer without presenting it.
+	void runLineRendering(StreamingBuffer &streamingBuffer);
+}
+
+#endif // YUBINOBUTAI_BENCHMARKS_H
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -12,6 +13,7 @@
 
 #include "BasicData.h"
 #include "Shader.h"
+#include "StreamingBuffer.h"
 #include "TextureAsset.h"
 
 #include "BitmapFont.h"
@@ -51,9 +53,12 @@ std::int64_t readInteger(const char *const buffer, const int bytes, const bool h
 
 } // namespace
 
-BitmapFont::BitmapFont(AAssetManager *const assetManager, const std::string &name):
+BitmapFont::BitmapFont(
+	AAssetManager *const assetManager, const std::string &name, StreamingBuffer &streamingBuffer
+):
+	streamingBuffer(streamingBuffer),
 	texture(std::move(TextureAsset::loadAsset(assetManager, name + "_0.png"))),
-	shader(std::move(Shader::loadShader(vertexShader, fragmentShader)))
+	shader(std::move(Shader::loadShader("BitmapFont", vertexShader, fragmentShader)))
 {
 	const auto shaderProgram = shader->getProgram();
 	uProjection = glGetUniformLocation(shaderProgram, "uProjection");
@@ -61,6 +66,12 @@ BitmapFont::BitmapFont(AAssetManager *const assetManager, const std::string &nam
 	inPosition = glGetAttribLocation(shaderProgram, "inPosition");
 	inUv = glGetAttribLocation(shaderProgram, "inUv");
 
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+	glEnableVertexAttribArray(inPosition);
+	glEnableVertexAttribArray(inUv);
+	glBindVertexArray(0);
+
 	const auto descriptorAsset = AAssetManager_open(assetManager, (name + ".fnt").c_str(), AASSET_MODE_BUFFER);
 	const char *dataPointer = static_cast<const char*>(AAsset_getBuffer(descriptorAsset));
 	int blockSize;
@@ -126,6 +137,10 @@ BitmapFont::BitmapFont(AAssetManager *const assetManager, const std::string &nam
 	AAsset_close(descriptorAsset);
 }
 
+BitmapFont::~BitmapFont() {
+	glDeleteVertexArrays(1, &vertexArray);
+}
+
 const BitmapFont::Glyph& BitmapFont::getGlyph(const char32_t character) const {
 	const auto glyphIter = glyphs.find(character);
 	return glyphIter == glyphs.end() ? glyphs.at(-1) : glyphIter->second;
@@ -193,19 +208,32 @@ void BitmapFont::render(
 		indexPointer[5] = static_cast<Index>(baseIndex);
 	}
 
-	glEnableVertexAttribArray(inPosition);
-	glEnableVertexAttribArray(inUv);
+	// Indices go into the same buffer, which GLES allows.
+	const std::size_t
+		indexSize = indices.size() * sizeof(Index),
+		vertexSize = vertices.size() * sizeof(RenderingVertex);
+	streamingBuffer.reserve(indexSize + StreamingBuffer::alignment + vertexSize);
+	const auto indexOffset = streamingBuffer.write(indices.data(), indexSize);
+	const auto vertexOffset = streamingBuffer.write(vertices.data(), vertexSize);
+	if (!indexOffset || !vertexOffset) return;
+
+	glBindVertexArray(vertexArray);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, streamingBuffer.getBuffer());
 	glVertexAttribPointer(
-		inPosition, 2, GL_FLOAT, GL_FALSE, sizeof(RenderingVertex), vertices[0].position.index
+		inPosition, 2, GL_FLOAT, GL_FALSE, sizeof(RenderingVertex),
+		reinterpret_cast<const void*>(*vertexOffset + offsetof(RenderingVertex, position))
 	);
 	glVertexAttribPointer(
-		inUv, 2, GL_FLOAT, GL_FALSE, sizeof(RenderingVertex), vertices[0].uv.index
+		inUv, 2, GL_FLOAT, GL_FALSE, sizeof(RenderingVertex),
+		reinterpret_cast<const void*>(*vertexOffset + offsetof(RenderingVertex, uv))
 	);
 
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, texture->getTextureId());
-	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_SHORT, indices.data());
+	glDrawElements(
+		GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_SHORT,
+		reinterpret_cast<const void*>(*indexOffset)
+	);
 
-	glDisableVertexAttribArray(inPosition);
-	glDisableVertexAttribArray(inUv);
+	glBindVertexArray(0);
 }
\ No newline at end of file
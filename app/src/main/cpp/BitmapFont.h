@@ -12,6 +12,7 @@
 
 #include "BasicData.h"
 #include "Shader.h"
+#include "StreamingBuffer.h"
 #include "TextureAsset.h"
 
 class BitmapFont {
@@ -25,9 +26,11 @@ class BitmapFont {
 			Vector2 uv;
 		};
 
+		StreamingBuffer &streamingBuffer;
 		std::shared_ptr<TextureAsset> texture;
 		std::unique_ptr<Shader> shader;
 		GLint uProjection, uColor, inPosition, inUv;
+		GLuint vertexArray = 0;
 
 		int baseSize, lineHeight, baseHeight, textureWidth, textureHeight;
 		std::unordered_map<char32_t, Glyph> glyphs;
@@ -38,7 +41,10 @@ class BitmapFont {
 			float width, height, heightFromBaseline;
 		};
 
-		BitmapFont(AAssetManager *const assetManager, const std::string &name);
+		BitmapFont(AAssetManager *const assetManager, const std::string &name, StreamingBuffer &streamingBuffer);
+		BitmapFont(const BitmapFont&) = delete;
+		BitmapFont& operator=(const BitmapFont&) = delete;
+		~BitmapFont();
 		MeasureResult measure(std::string_view text, float size) const;
 		void render(std::string_view text, float size, const glm::mat4 &matrix, Vector4 color) const;
 };
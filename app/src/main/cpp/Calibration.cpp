@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Calibration.h"
+
+namespace {
+	constexpr double flashDuration = 100.;
+	// Scales the median absolute deviation to a standard deviation estimate for normally distributed errors.
+	constexpr double madScale = 1.4826;
+	constexpr double outlierThreshold = 3.;
+
+	double median(std::vector<double> &values) {
+		const auto middle = values.begin() + values.size() / 2;
+		std::nth_element(values.begin(), middle, values.end());
+		if (values.size() % 2 != 0) return *middle;
+		return (*middle + *std::max_element(values.begin(), middle)) / 2.;
+	}
+} // namespace
+
+std::optional<Calibration::Offsets> Calibration::load(const std::string &path) {
+	std::ifstream stream(path);
+	Offsets offsets;
+	stream >> offsets.audio >> offsets.visual;
+	if (!stream) return std::nullopt;
+	return offsets;
+}
+
+void Calibration::save(const std::string &path, const Offsets offsets) {
+	std::ofstream stream(path);
+	stream << offsets.audio << ' ' << offsets.visual << '\n';
+}
+
+Calibration::Calibration(const double beatInterval, const int leadInBeats, const int beatsPerPhase):
+	beatInterval(beatInterval), leadInBeats(leadInBeats), beatsPerPhase(beatsPerPhase)
+{}
+
+Calibration::Phase Calibration::getPhase(const double time) const {
+	const double beat = time / beatInterval;
+	// Leave half a beat after the last beat of each phase for late taps.
+	return beat < beatsPerPhase - .5 ? Phase::Audio
+		: beat < beatsPerPhase * 2 - .5 ? Phase::Visual
+		: Phase::Done;
+}
+
+bool Calibration::isFlashing(const double time) const {
+	if (getPhase(time) != Phase::Visual) return false;
+	const double sinceBeat = std::fmod(time, beatInterval);
+	return sinceBeat >= 0. && sinceBeat < flashDuration;
+}
+
+void Calibration::addTap(const double time) {
+	const int beat = static_cast<int>(std::round(time / beatInterval));
+	const int beatInPhase = beat % beatsPerPhase;
+	if (beat < 0 || beatInPhase < leadInBeats) return;
+	const double error = time - beat * beatInterval;
+	switch (getPhase(time)) {
+		case Phase::Audio:
+			audioErrors.push_back(error);
+			break;
+		case Phase::Visual:
+			visualErrors.push_back(error);
+			break;
+		case Phase::Done:
+			break;
+	}
+}
+
+double Calibration::computeOffset(std::vector<double> &errors) {
+	if (errors.empty()) return 0.;
+	const double center = median(errors);
+	std::vector<double> deviations(errors.size());
+	std::transform(errors.begin(), errors.end(), deviations.begin(), [center](const double error) {
+		return std::abs(error - center);
+	});
+	const double spread = median(deviations) * madScale;
+	// Drop taps too far from the rest, e.g. missed or doubled beats, then settle on the median of the others.
+	if (spread > 0.) errors.erase(std::remove_if(errors.begin(), errors.end(), [center, spread](const double error) {
+		return std::abs(error - center) > spread * outlierThreshold;
+	}), errors.end());
+	return median(errors);
+}
+
+Calibration::Offsets Calibration::getOffsets() const {
+	std::vector<double> audio = audioErrors, visual = visualErrors;
+	return {computeOffset(audio), computeOffset(visual)};
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef YUBINOBUTAI_CALIBRATION_H
+#define YUBINOBUTAI_CALIBRATION_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// Measures how late the player taps relative to what they hear and to what they see. The first phase plays clicks,
+// the second one flashes a line silently, both on the same beat grid. Times are in milliseconds.
+class Calibration final {
+	public:
+		enum class Phase {Audio, Visual, Done};
+		struct Offsets {
+			// How much later taps land than the audio clock, when following sound.
+			double audio = 0.;
+			// Likewise, when following visuals.
+			double visual = 0.;
+		};
+
+		static std::optional<Offsets> load(const std::string &path);
+		static void save(const std::string &path, Offsets offsets);
+	private:
+		double beatInterval;
+		int leadInBeats, beatsPerPhase;
+		std::vector<double> audioErrors, visualErrors;
+
+		static double computeOffset(std::vector<double> &errors);
+	public:
+		Calibration(double beatInterval = 500., int leadInBeats = 4, int beatsPerPhase = 20);
+		double getBeatInterval() const {
+			return beatInterval;
+		}
+		// Number of clicks the audio phase needs.
+		int getClickCount() const {
+			return beatsPerPhase;
+		}
+		Phase getPhase(double time) const;
+		bool isFlashing(double time) const;
+		int getTapCount() const {
+			return static_cast<int>(audioErrors.size() + visualErrors.size());
+		}
+		void addTap(double time);
+		Offsets getOffsets() const;
+};
+
+#endif // YUBINOBUTAI_CALIBRATION_H
\ No newline at end of file
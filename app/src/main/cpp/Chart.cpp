@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Chart.h"
+
+namespace {
+	constexpr char magic[4] = {'Y', 'N', 'B', 'C'};
+	constexpr std::size_t headerSizeVersion1 = 16, headerSize = 20, columnEntrySize = 8;
+
+	std::uint32_t readUint32(const unsigned char *const data) {
+		std::uint32_t value;
+		std::memcpy(&value, data, 4);
+		return value;
+	}
+
+	void appendUint32(std::vector<unsigned char> &output, const std::uint32_t value) {
+		const auto *const bytes = reinterpret_cast<const unsigned char*>(&value);
+		output.insert(output.end(), bytes, bytes + 4);
+	}
+
+	bool isWhitespace(const char character) {
+		return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+	}
+
+	// A non-negative decimal number. `std::from_chars` for floating point isn't available everywhere yet.
+	bool parseSpeed(const char *&current, const char *const end, float &value) {
+		std::uint32_t whole;
+		const auto result = std::from_chars(current, end, whole);
+		if (result.ec != std::errc()) return false;
+		current = result.ptr;
+		double fraction = 0., scale = 1.;
+		if (current != end && *current == '.') {
+			for (++current; current != end && *current >= '0' && *current <= '9'; ++current) {
+				scale /= 10.;
+				fraction += (*current - '0') * scale;
+			}
+		}
+		value = static_cast<float>(whole + fraction);
+		return true;
+	}
+} // namespace
+
+#ifdef __ANDROID__
+std::optional<Chart> Chart::fromAsset(AAssetManager *const assetManager, const std::string &name) {
+	const std::unique_ptr<AAsset, void(*)(AAsset*)> asset(
+		AAssetManager_open(assetManager, name.c_str(), AASSET_MODE_RANDOM), AAsset_close
+	);
+	if (asset == nullptr) return std::nullopt;
+	Chart chart;
+	off64_t start, length;
+	const int descriptor = AAsset_openFileDescriptor64(asset.get(), &start, &length);
+	if (descriptor >= 0) {
+		// Uncompressed inside the APK, map it directly. The mapping has to start on a page boundary.
+		const off64_t pageStart = start & ~static_cast<off64_t>(sysconf(_SC_PAGESIZE) - 1);
+		const auto mappingSize = static_cast<std::size_t>(length + (start - pageStart));
+		void *const mapping = mmap64(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, descriptor, pageStart);
+		close(descriptor);
+		if (mapping != MAP_FAILED) {
+			chart.mapping = mapping;
+			chart.mappingSize = mappingSize;
+			chart.data = static_cast<const unsigned char*>(mapping) + (start - pageStart);
+			chart.size = static_cast<std::size_t>(length);
+		}
+	}
+	if (chart.data == nullptr) {
+		// Compressed, so it has to be inflated into memory anyway.
+		const auto *const buffer = static_cast<const unsigned char*>(AAsset_getBuffer(asset.get()));
+		if (buffer == nullptr) return std::nullopt;
+		chart.ownedData.assign(buffer, buffer + AAsset_getLength64(asset.get()));
+		chart.data = chart.ownedData.data();
+		chart.size = chart.ownedData.size();
+	}
+	if (!chart.validate()) return std::nullopt;
+	return chart;
+}
+#endif
+
+std::optional<Chart> Chart::fromFile(const std::string &path) {
+	const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (descriptor < 0) return std::nullopt;
+	struct stat status;
+	void *mapping = MAP_FAILED;
+	if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+		mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+	if (mapping == MAP_FAILED) return std::nullopt;
+	Chart chart;
+	chart.mapping = mapping;
+	chart.mappingSize = static_cast<std::size_t>(status.st_size);
+	chart.data = static_cast<const unsigned char*>(mapping);
+	chart.size = chart.mappingSize;
+	if (!chart.validate()) return std::nullopt;
+	return chart;
+}
+
+std::optional<Chart> Chart::fromData(std::vector<unsigned char> data) {
+	Chart chart;
+	chart.ownedData = std::move(data);
+	chart.data = chart.ownedData.data();
+	chart.size = chart.ownedData.size();
+	if (!chart.validate()) return std::nullopt;
+	return chart;
+}
+
+bool Chart::convertText(const char *const text, const std::size_t size, std::vector<unsigned char> &output) {
+	std::vector<Note> parsedNotes;
+	std::vector<SpeedChange> parsedSpeedChanges;
+	const char *current = text, *const end = text + size;
+	const auto skipWhitespace = [&current, end]() {
+		while (current != end && isWhitespace(*current)) ++current;
+		return current != end;
+	};
+	const auto readNumber = [&current, end, &skipWhitespace](std::int32_t &value) {
+		if (!skipWhitespace()) return false;
+		const auto result = std::from_chars(current, end, value);
+		if (result.ec != std::errc()) return false;
+		current = result.ptr;
+		return true;
+	};
+	constexpr std::string_view speedKeyword = "speed";
+	while (skipWhitespace()) {
+		if (std::string_view(current, end - current).substr(0, speedKeyword.size()) == speedKeyword) {
+			current += speedKeyword.size();
+			SpeedChange speedChange;
+			if (!readNumber(speedChange.time) || !skipWhitespace() || !parseSpeed(current, end, speedChange.speed))
+				return false;
+			parsedSpeedChanges.push_back(speedChange);
+			continue;
+		}
+		Note note;
+		if (!readNumber(note.time) || !readNumber(note.position)) return false;
+		parsedNotes.push_back(note);
+	}
+	std::stable_sort(parsedNotes.begin(), parsedNotes.end(), [](const Note &first, const Note &second) {
+		return first.time < second.time;
+	});
+	std::stable_sort(
+		parsedSpeedChanges.begin(), parsedSpeedChanges.end(),
+		[](const SpeedChange &first, const SpeedChange &second) {
+			return first.time < second.time;
+		}
+	);
+
+	output.clear();
+	output.reserve(
+		headerSize + parsedNotes.size() * sizeof(Note) + parsedSpeedChanges.size() * sizeof(SpeedChange)
+	);
+	output.insert(output.end(), magic, magic + 4);
+	appendUint32(output, version);
+	appendUint32(output, static_cast<std::uint32_t>(parsedNotes.size()));
+	appendUint32(output, 0);
+	appendUint32(output, static_cast<std::uint32_t>(parsedSpeedChanges.size()));
+	for (const Note &note : parsedNotes) {
+		appendUint32(output, static_cast<std::uint32_t>(note.time));
+		appendUint32(output, static_cast<std::uint32_t>(note.position));
+	}
+	for (const SpeedChange &speedChange : parsedSpeedChanges) {
+		std::uint32_t speedBits;
+		std::memcpy(&speedBits, &speedChange.speed, 4);
+		appendUint32(output, static_cast<std::uint32_t>(speedChange.time));
+		appendUint32(output, speedBits);
+	}
+	return true;
+}
+
+bool Chart::validate() {
+	// Values are read in place, so everything has to be suitably aligned.
+	if (
+		size < headerSizeVersion1 || reinterpret_cast<std::uintptr_t>(data) % alignof(Note) != 0
+		|| std::memcmp(data, magic, 4) != 0
+	) return false;
+	const std::uint32_t fileVersion = readUint32(data + 4);
+	if (fileVersion != 1 && (fileVersion != version || size < headerSize)) return false;
+	fileHeaderSize = fileVersion == 1 ? headerSizeVersion1 : headerSize;
+	noteCount = readUint32(data + 8);
+	columnCount = readUint32(data + 12);
+	speedChangeCount = fileVersion == 1 ? 0 : readUint32(data + 16);
+	const std::size_t notesOffset = fileHeaderSize + static_cast<std::size_t>(columnCount) * columnEntrySize;
+	if (notesOffset > size || (size - notesOffset) / sizeof(Note) < noteCount) return false;
+	const std::size_t speedChangesOffset = notesOffset + static_cast<std::size_t>(noteCount) * sizeof(Note);
+	if ((size - speedChangesOffset) / sizeof(SpeedChange) < speedChangeCount) return false;
+	const std::size_t columnSize = static_cast<std::size_t>(noteCount) * 4;
+	for (std::uint32_t i = 0; i != columnCount; ++i) {
+		const std::size_t offset = readUint32(data + fileHeaderSize + i * columnEntrySize + 4);
+		if (offset % 4 != 0 || offset > size || size - offset < columnSize) return false;
+	}
+	notes = reinterpret_cast<const Note*>(data + notesOffset);
+	speedChanges = reinterpret_cast<const SpeedChange*>(data + speedChangesOffset);
+	// Lookups search by time, and the playfield relies on distances never decreasing along the chart.
+	for (std::uint32_t i = 1; i < noteCount; ++i) {
+		if (notes[i].time < notes[i - 1].time) return false;
+	}
+	for (std::uint32_t i = 0; i != speedChangeCount; ++i) {
+		const float speed = speedChanges[i].speed;
+		if (!std::isfinite(speed) || speed < 0.f) return false;
+		if (i != 0 && speedChanges[i].time < speedChanges[i - 1].time) return false;
+	}
+	return true;
+}
+
+Chart::Chart(Chart &&other) noexcept:
+	mapping(std::exchange(other.mapping, nullptr)), mappingSize(other.mappingSize),
+	ownedData(std::move(other.ownedData)),
+	data(other.data), size(other.size), fileHeaderSize(other.fileHeaderSize),
+	notes(other.notes), speedChanges(other.speedChanges),
+	noteCount(other.noteCount), columnCount(other.columnCount), speedChangeCount(other.speedChangeCount)
+{}
+
+Chart::~Chart() {
+	if (mapping != nullptr) munmap(mapping, mappingSize);
+}
+
+const std::int32_t* Chart::getColumn(const char tag[4]) const {
+	for (std::uint32_t i = 0; i != columnCount; ++i) {
+		const unsigned char *const entry = data + fileHeaderSize + i * columnEntrySize;
+		if (std::memcmp(entry, tag, 4) == 0) return reinterpret_cast<const std::int32_t*>(data + readUint32(entry + 4));
+	}
+	return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef YUBINOBUTAI_CHART_H
+#define YUBINOBUTAI_CHART_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct AAssetManager;
+
+/*
+	Binary chart format, little endian, every field 4 bytes wide and aligned:
+	- Header: the magic "YNBC", the format version, the note count, the number of extra columns and, from version 2,
+	  the number of speed changes.
+	- Column directory: for each extra column, a 4-character tag and the byte offset of its data from the start of the
+	  file. A column holds one 32-bit value per note, in note order. Readers ignore tags they don't know.
+	- Note table, right after the directory: time in milliseconds and position for each note, sorted by time.
+	- Speed change table, right after the notes: time in milliseconds and scroll speed multiplier as a float, sorted by
+	  time. Speed starts at 1.
+
+	The file is used in place, mapped straight from the APK when the asset is stored uncompressed, so loading costs
+	nothing beyond checking the header.
+
+	Apart from loading assets, this builds anywhere POSIX, for tools that work with charts.
+*/
+class Chart final {
+	public:
+		struct Note {
+			std::int32_t time;
+			std::int32_t position;
+		};
+		// The scroll speed, relative to the base speed, from the time on. Never negative.
+		struct SpeedChange {
+			std::int32_t time;
+			float speed;
+		};
+
+		// Version 1 files, without speed changes, are still read.
+		static constexpr std::uint32_t version = 2;
+
+#ifdef __ANDROID__
+		static std::optional<Chart> fromAsset(AAssetManager *assetManager, const std::string &name);
+#endif
+		static std::optional<Chart> fromFile(const std::string &path);
+		static std::optional<Chart> fromData(std::vector<unsigned char> data);
+		// Converts the text format into the binary format. The text is whitespace separated time and position pairs
+		// for notes, and `speed`, time and multiplier triples for speed changes. Returns `false` if the text is
+		// malformed.
+		static bool convertText(const char *text, std::size_t size, std::vector<unsigned char> &output);
+	private:
+		void *mapping = nullptr;
+		std::size_t mappingSize = 0;
+		std::vector<unsigned char> ownedData;
+		const unsigned char *data = nullptr;
+		std::size_t size = 0, fileHeaderSize = 0;
+		const Note *notes = nullptr;
+		const SpeedChange *speedChanges = nullptr;
+		std::uint32_t noteCount = 0, columnCount = 0, speedChangeCount = 0;
+
+		Chart() = default;
+		bool validate();
+	public:
+		Chart(Chart &&other) noexcept;
+		Chart& operator=(Chart&&) = delete;
+		~Chart();
+		const Note* getNotes() const {
+			return notes;
+		}
+		std::size_t getNoteCount() const {
+			return noteCount;
+		}
+		const SpeedChange* getSpeedChanges() const {
+			return speedChanges;
+		}
+		std::size_t getSpeedChangeCount() const {
+			return speedChangeCount;
+		}
+		// Returns the values of an extra column, or `nullptr` if the chart doesn't have it.
+		const std::int32_t* getColumn(const char tag[4]) const;
+};
+
+#endif // YUBINOBUTAI_CHART_H
\ No newline at end of file
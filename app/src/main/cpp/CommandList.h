@@ -0,0 +1,48 @@
+#ifndef YUBINOBUTAI_COMMANDLIST_H
+#define YUBINOBUTAI_COMMANDLIST_H
+
+#include "FrameArena.h"
+#include "RenderQueue.h"
+
+// Draws recorded away from the GL thread. Recording only computes: each entry keeps its data in the list's own arena
+// along with the function that turns it into GL work, which `submit` later runs on the GL thread. One thread records
+// into a list at a time.
+class CommandList final {
+	private:
+		struct Entry {
+			void (*submit)(const void *payload, RenderQueue &queue);
+			const void *payload;
+			Entry *next;
+		};
+
+		FrameArena arena;
+		Entry *first = nullptr, *last = nullptr;
+	public:
+		FrameArena& getArena() {
+			return arena;
+		}
+		// The payload is copied into the arena.
+		template<typename Payload, void (*submitPayload)(const Payload&, RenderQueue&)>
+		void record(const Payload &payload) {
+			Entry *const entry = arena.create<Entry>(
+				[](const void *const storedPayload, RenderQueue &queue) {
+					submitPayload(*static_cast<const Payload*>(storedPayload), queue);
+				},
+				arena.create<Payload>(payload), nullptr
+			);
+			if (last) last->next = entry;
+			else first = entry;
+			last = entry;
+		}
+		// On the GL thread, in the order recorded.
+		void submit(RenderQueue &queue) const {
+			for (const Entry *entry = first; entry; entry = entry->next) entry->submit(entry->payload, queue);
+		}
+		// Once submitted, to start the next frame.
+		void reset() {
+			arena.reset();
+			first = last = nullptr;
+		}
+};
+
+#endif // YUBINOBUTAI_COMMANDLIST_H
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "FrameArena.h"
+
+FrameArena::FrameArena(const std::size_t initialSize) {
+	addBlock(initialSize);
+}
+
+void FrameArena::addBlock(const std::size_t minimumSize) {
+	const std::size_t size = std::max(minimumSize, blocks.empty() ? std::size_t(0) : blocks.back().size * 2);
+	blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+	usedSize = 0;
+}
+
+void* FrameArena::allocate(const std::size_t size, const std::size_t alignment) {
+	Block &block = blocks.back();
+	const auto address = reinterpret_cast<std::uintptr_t>(block.data.get()) + usedSize;
+	const std::size_t start = usedSize + (alignment - address % alignment) % alignment;
+	if (start + size <= block.size) {
+		usedSize = start + size;
+		return block.data.get() + start;
+	}
+	// `new[]` aligns for any fundamental type.
+	addBlock(size);
+	usedSize = size;
+	return blocks.back().data.get();
+}
+
+void FrameArena::reset() {
+	if (blocks.size() > 1) {
+		std::size_t totalSize = 0;
+		for (const Block &block : blocks) totalSize += block.size;
+		blocks.clear();
+		addBlock(totalSize);
+	}
+	usedSize = 0;
+}
\ No newline at end of file
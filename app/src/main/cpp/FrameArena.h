@@ -0,0 +1,42 @@
+#ifndef YUBINOBUTAI_FRAMEARENA_H
+#define YUBINOBUTAI_FRAMEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for data that lives for one frame. Nothing is freed individually; `reset` drops everything at once.
+// A frame that outgrows the block spills into extra blocks, and the next reset merges them into one big enough, so
+// from then on a frame of the same size allocates nothing. Not thread safe: give each thread its own.
+class FrameArena final {
+	private:
+		struct Block {
+			std::unique_ptr<unsigned char[]> data;
+			std::size_t size;
+		};
+
+		std::vector<Block> blocks;
+		std::size_t usedSize = 0;
+
+		void addBlock(std::size_t minimumSize);
+	public:
+		explicit FrameArena(std::size_t initialSize = 64 << 10);
+		void* allocate(std::size_t size, std::size_t alignment);
+		// Only for trivially destructible types, no destructors are run.
+		template<typename T>
+		T* allocateArray(const std::size_t count) {
+			static_assert(std::is_trivially_destructible_v<T>);
+			return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+		}
+		template<typename T, typename... Arguments>
+		T* create(Arguments&&... arguments) {
+			static_assert(std::is_trivially_destructible_v<T>);
+			return new (allocate(sizeof(T), alignof(T))) T{std::forward<Arguments>(arguments)...};
+		}
+		void reset();
+};
+
+#endif // YUBINOBUTAI_FRAMEARENA_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "FramePacer.h"
+
+namespace {
+	constexpr double averageWeight = 0.05;
+	// The work estimate rises to a slow frame at once, then falls back gradually.
+	constexpr std::int64_t workEstimateFallDivisor = 16;
+} // namespace
+
+void FramePacer::setRefreshPeriod(const std::int64_t period) {
+	refreshPeriod = period;
+}
+
+void FramePacer::onVsync(const std::int64_t time) {
+	if (lastVsyncTime != 0 && time > lastVsyncTime) {
+		const std::int64_t interval = time - lastVsyncTime;
+		// Callbacks can skip vsyncs, only trust intervals that look like a single period.
+		if (refreshPeriod == 0 || interval < refreshPeriod * 3 / 2) refreshPeriod = refreshPeriod == 0
+			? interval
+			: refreshPeriod + (interval - refreshPeriod) / 8;
+	}
+	lastVsyncTime = time;
+}
+
+std::int64_t FramePacer::getNextTargetVsyncTime(const std::int64_t time) const {
+	const std::int64_t deadline = time + std::min(workEstimate, refreshPeriod) + margin;
+	std::int64_t vsyncTime = lastVsyncTime;
+	if (deadline > vsyncTime)
+		vsyncTime += (deadline - vsyncTime + refreshPeriod - 1) / refreshPeriod * refreshPeriod;
+	return std::max(vsyncTime, targetVsyncTime + refreshPeriod);
+}
+
+int FramePacer::getPollTimeout() const {
+	if (lastVsyncTime == 0 || refreshPeriod == 0) return 0;
+	const std::int64_t time = clock();
+	const std::int64_t startTime
+		= getNextTargetVsyncTime(time) - std::min(workEstimate, refreshPeriod) - margin;
+	// Rounded down, starting a little early only costs some latency, starting late misses the vsync.
+	return startTime > time ? static_cast<int>((startTime - time) / 1'000'000) : 0;
+}
+
+void FramePacer::beginFrame() {
+	frameStartTime = clock();
+	if (lastVsyncTime != 0 && refreshPeriod != 0) targetVsyncTime = getNextTargetVsyncTime(frameStartTime);
+	if (lastFrameStartTime != 0) {
+		const std::int64_t interval = frameStartTime - lastFrameStartTime;
+		averageFrameInterval += (interval / 1e6 - averageFrameInterval) * averageWeight;
+		if (refreshPeriod != 0 && interval > refreshPeriod * 3 / 2) ++lateFrameCount;
+	}
+	lastFrameStartTime = frameStartTime;
+	++frameCount;
+}
+
+void FramePacer::endFrame() {
+	const std::int64_t workTime = clock() - frameStartTime;
+	workEstimate = workTime > workEstimate
+		? workTime
+		: workEstimate - (workEstimate - workTime) / workEstimateFallDivisor;
+	averageWorkTime += (workTime / 1e6 - averageWorkTime) * averageWeight;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef YUBINOBUTAI_FRAMEPACER_H
+#define YUBINOBUTAI_FRAMEPACER_H
+
+#include <cstdint>
+
+#include <audio/AudioClock.h>
+
+// Decides when the main loop should start each frame. Rather than rendering as soon as the last swap returns, which
+// queues frames up behind the display, a frame starts just late enough to finish its work before the next vsync, so
+// input and the song time are sampled as late as possible. Also keeps statistics about frame intervals. All times are
+// in nanoseconds on the clock given, which has to be the one vsync times are reported on.
+class FramePacer final {
+	public:
+		using Clock = std::int64_t(*)();
+		// Extra time left between the expected end of the work and the vsync.
+		static constexpr std::int64_t margin = 2'000'000;
+	private:
+		Clock clock;
+		std::int64_t refreshPeriod = 0;
+		// Zero until a vsync is reported, then pacing is off.
+		std::int64_t lastVsyncTime = 0;
+		// The vsync the current or last frame was meant for.
+		std::int64_t targetVsyncTime = 0;
+		std::int64_t workEstimate = 0;
+		std::int64_t frameStartTime = 0, lastFrameStartTime = 0;
+		double averageFrameInterval = 0., averageWorkTime = 0.;
+		int frameCount = 0, lateFrameCount = 0;
+
+		// The first vsync that a frame starting now can make and that no earlier frame was meant for.
+		std::int64_t getNextTargetVsyncTime(std::int64_t time) const;
+	public:
+		explicit FramePacer(Clock clock = AudioClock::now): clock(clock) {}
+
+		// From the display, when known. Otherwise it's estimated from the vsyncs reported.
+		void setRefreshPeriod(std::int64_t period);
+		void onVsync(std::int64_t time);
+		// How long the loop can block waiting for events before the next frame should start, in milliseconds. 0 if it
+		// should start right away.
+		int getPollTimeout() const;
+		// Around the frame's CPU work, not including the buffer swap, which waits for the display.
+		void beginFrame();
+		void endFrame();
+
+		std::int64_t getRefreshPeriod() const {
+			return refreshPeriod;
+		}
+		// The vsync the current or last frame was meant for, 0 while pacing is off.
+		std::int64_t getTargetVsyncTime() const {
+			return targetVsyncTime;
+		}
+		// Exponential moving averages, in milliseconds.
+		double getAverageFrameInterval() const {
+			return averageFrameInterval;
+		}
+		double getAverageWorkTime() const {
+			return averageWorkTime;
+		}
+		int getFrameCount() const {
+			return frameCount;
+		}
+		// Frames that started more than one and a half refresh periods after the one before.
+		int getLateFrameCount() const {
+			return lateFrameCount;
+		}
+};
+
+#endif // YUBINOBUTAI_FRAMEPACER_H
\ No newline at end of file
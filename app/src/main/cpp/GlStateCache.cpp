@@ -0,0 +1,90 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <GLES3/gl3.h>
+
+#include "GlStateCache.h"
+
+void GlStateCache::useProgram(const GLuint newProgram) {
+	if (!isNeeded(newProgram == program)) return;
+	glUseProgram(newProgram);
+	program = newProgram;
+}
+
+void GlStateCache::bindVertexArray(const GLuint newVertexArray) {
+	if (!isNeeded(newVertexArray == vertexArray)) return;
+	glBindVertexArray(newVertexArray);
+	vertexArray = newVertexArray;
+}
+
+void GlStateCache::bindTexture(const int unit, const GLuint texture) {
+	if (!isNeeded(textures[unit] == texture)) return;
+	if (isNeeded(activeTextureUnit == unit)) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		activeTextureUnit = unit;
+	}
+	glBindTexture(GL_TEXTURE_2D, texture);
+	textures[unit] = texture;
+}
+
+void GlStateCache::bindArrayBuffer(const GLuint buffer) {
+	if (!isNeeded(buffer == arrayBuffer)) return;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	arrayBuffer = buffer;
+}
+
+void GlStateCache::setVertexAttributePointer(
+	const GLuint location, const GLuint buffer, const GLint size, const GLsizei stride, const std::uintptr_t offset
+) {
+	const auto key = static_cast<std::uint64_t>(vertexArray) << 32 | location;
+	const auto [iterator, isNew] = vertexAttributes.try_emplace(key);
+	VertexAttributePointer &pointer = iterator->second;
+	if (!isNeeded(
+		!isNew && vertexArray != unknown
+		&& pointer.buffer == buffer && pointer.size == size && pointer.stride == stride && pointer.offset == offset
+	)) return;
+	bindArrayBuffer(buffer);
+	glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
+	pointer = {buffer, size, stride, offset};
+}
+
+void GlStateCache::setUniform(const GLint location, const UniformType type, const float *const value) {
+	const std::size_t size = getUniformSize(type) * sizeof(float);
+	const auto key = static_cast<std::uint64_t>(program) << 32 | static_cast<std::uint32_t>(location);
+	const auto [iterator, isNew] = uniforms.try_emplace(key);
+	if (!isNeeded(!isNew && std::memcmp(iterator->second.data, value, size) == 0)) return;
+	std::memcpy(iterator->second.data, value, size);
+	switch (type) {
+		case UniformType::Float:
+			glUniform1f(location, *value);
+			break;
+		case UniformType::Vector2:
+			glUniform2fv(location, 1, value);
+			break;
+		case UniformType::Vector4:
+			glUniform4fv(location, 1, value);
+			break;
+		case UniformType::Matrix4:
+			glUniformMatrix4fv(location, 1, GL_FALSE, value);
+			break;
+	}
+}
+
+void GlStateCache::forgetAll() {
+	program = unknown;
+	vertexArray = unknown;
+	uniforms.clear();
+	forgetTextures();
+	forgetVertexBuffers();
+}
+
+void GlStateCache::forgetTextures() {
+	activeTextureUnit = -1;
+	for (GLuint &texture : textures) texture = unknown;
+}
+
+void GlStateCache::forgetVertexBuffers() {
+	arrayBuffer = unknown;
+	vertexAttributes.clear();
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef YUBINOBUTAI_GLSTATECACHE_H
+#define YUBINOBUTAI_GLSTATECACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+
+#include <GLES3/gl3.h>
+
+// Remembers the GL state set through it and skips calls that wouldn't change anything. Code that changes the same
+// state behind its back has to say so with one of the `forget` functions.
+class GlStateCache final {
+	public:
+		enum class UniformType {
+			Float, Vector2, Vector4, Matrix4
+		};
+		struct Stats {
+			long issuedCalls = 0, skippedCalls = 0;
+		};
+		static constexpr int textureUnitCount = 4;
+
+		static int getUniformSize(const UniformType type) {
+			return type == UniformType::Float ? 1
+				: type == UniformType::Vector2 ? 2
+				: type == UniformType::Vector4 ? 4
+				: 16;
+		}
+	private:
+		// Never a real name, so the first call after forgetting always goes through.
+		static constexpr GLuint unknown = ~0u;
+
+		struct UniformValue {
+			float data[16];
+		};
+		struct VertexAttributePointer {
+			GLuint buffer;
+			GLint size;
+			GLsizei stride;
+			std::uintptr_t offset;
+		};
+
+		GLuint program = unknown, vertexArray = unknown, arrayBuffer = unknown;
+		int activeTextureUnit = -1;
+		GLuint textures[textureUnitCount];
+		// By program and location.
+		std::unordered_map<std::uint64_t, UniformValue> uniforms;
+		// By vertex array and location.
+		std::unordered_map<std::uint64_t, VertexAttributePointer> vertexAttributes;
+		Stats stats;
+
+		bool isNeeded(const bool isRedundant) {
+			if (isRedundant) ++stats.skippedCalls;
+			else ++stats.issuedCalls;
+			return !isRedundant;
+		}
+	public:
+		GlStateCache() {
+			forgetTextures();
+		}
+		void useProgram(GLuint newProgram);
+		void bindVertexArray(GLuint newVertexArray);
+		void bindTexture(int unit, GLuint texture);
+		void bindArrayBuffer(GLuint buffer);
+		// Points a float attribute of the bound vertex array into the buffer, binding it to `GL_ARRAY_BUFFER` first.
+		void setVertexAttributePointer(
+			GLuint location, GLuint buffer, GLint size, GLsizei stride, std::uintptr_t offset
+		);
+		// Sets a uniform of the program in use.
+		void setUniform(GLint location, UniformType type, const float *value);
+
+		void forgetAll();
+		void forgetTextures();
+		// The array buffer binding and the attribute pointers. Needed after binding buffers elsewhere, and after
+		// deleting any that attributes pointed into, since their names can come back for new buffers.
+		void forgetVertexBuffers();
+		const Stats& getStats() const {
+			return stats;
+		}
+};
+
+#endif // YUBINOBUTAI_GLSTATECACHE_H
\ No newline at end of file
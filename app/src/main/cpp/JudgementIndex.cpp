@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Chart.h"
+
+#include "JudgementIndex.h"
+
+JudgementIndex::JudgementIndex(const Chart::Note *const notes, const std::size_t noteCount, const double window):
+	notes(notes), noteCount(noteCount), window(window), hitNotes(noteCount, false)
+{
+	// Notes are already sorted by time, so each column's list comes out sorted too.
+	for (std::size_t i = 0; i != noteCount; ++i) {
+		const int
+			firstColumn = std::max(notes[i].position, 0),
+			pastLastColumn = std::min(notes[i].position + noteWidth, columnCount);
+		for (int column = firstColumn; column < pastLastColumn; ++column)
+			columnNotes[column].push_back(static_cast<std::uint32_t>(i));
+	}
+}
+
+bool JudgementIndex::advance(const double time) {
+	const double windowStart = time - window;
+	const std::size_t oldMissCursor = missCursor;
+	for (; missCursor != noteCount && notes[missCursor].time <= windowStart; ++missCursor)
+		if (!hitNotes[missCursor]) ++missCount;
+	// The column cursors follow the same notes, so they can't have moved if this one didn't.
+	if (missCursor == oldMissCursor) return false;
+	for (int column = 0; column != columnCount; ++column) {
+		const auto &lane = columnNotes[column];
+		std::size_t &cursor = columnCursors[column];
+		while (cursor != lane.size() && notes[lane[cursor]].time <= windowStart) ++cursor;
+	}
+	return true;
+}
+
+long JudgementIndex::hit(const int column, const double time) {
+	if (column < 0 || column >= columnCount) return -1;
+	const auto &lane = columnNotes[column];
+	const auto begin = lane.begin() + static_cast<std::ptrdiff_t>(columnCursors[column]);
+	const auto split = std::lower_bound(begin, lane.end(), time, [this](const std::uint32_t index, const double time) {
+		return notes[index].time < time;
+	});
+	// The closest unjudged note on each side of the split.
+	long best = -1;
+	double bestDistance = window;
+	for (auto iterator = split; iterator != begin;) {
+		--iterator;
+		const double distance = time - notes[*iterator].time;
+		if (distance >= window) break;
+		if (!hitNotes[*iterator]) {
+			best = *iterator;
+			bestDistance = distance;
+			break;
+		}
+	}
+	for (auto iterator = split; iterator != lane.end(); ++iterator) {
+		const double distance = notes[*iterator].time - time;
+		if (distance >= bestDistance) break;
+		if (!hitNotes[*iterator]) {
+			best = *iterator;
+			break;
+		}
+	}
+	if (best == -1 || static_cast<std::size_t>(best) < missCursor) return -1;
+	hitNotes[best] = true;
+	++hitCount;
+	return best;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef YUBINOBUTAI_JUDGEMENTINDEX_H
+#define YUBINOBUTAI_JUDGEMENTINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Chart.h"
+
+// Finds which note a tap hits. Notes are split into one time-sorted list per column they cover, each with a cursor
+// that moves past notes once their window is over, so a tap only does a binary search within its own column. Times
+// are in milliseconds.
+class JudgementIndex final {
+	public:
+		static constexpr int columnCount = 12;
+		// How many columns each note covers, starting at its position.
+		static constexpr int noteWidth = 3;
+	private:
+		const Chart::Note *notes;
+		std::size_t noteCount;
+		double window;
+		std::vector<std::uint32_t> columnNotes[columnCount];
+		std::size_t columnCursors[columnCount] = {};
+		std::vector<bool> hitNotes;
+		// Every note before this has had its window pass.
+		std::size_t missCursor = 0;
+		int hitCount = 0, missCount = 0;
+	public:
+		// A note can be hit while the tap is less than `window` away from it.
+		JudgementIndex(const Chart::Note *notes, std::size_t noteCount, double window = 100.);
+		// Counts the notes whose window has passed without a hit as missed. Returns whether any note's window passed.
+		bool advance(double time);
+		// Hits the unjudged note in the column closest to the time, if any is within the window. Returns its index, or
+		// -1.
+		long hit(int column, double time);
+		bool isHit(const std::size_t noteIndex) const {
+			return hitNotes[noteIndex];
+		}
+		const std::vector<bool>& getHitNotes() const {
+			return hitNotes;
+		}
+		int getHitCount() const {
+			return hitCount;
+		}
+		int getMissCount() const {
+			return missCount;
+		}
+};
+
+#endif // YUBINOBUTAI_JUDGEMENTINDEX_H
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "Chart.h"
+#include "Replay.h"
+
+#include "JudgementState.h"
+
+void JudgementState::ErrorStatistics::add(const double error) {
+	min = count == 0 ? error : std::min(min, error);
+	max = count == 0 ? error : std::max(max, error);
+	++count;
+	sum += error;
+	sumOfSquares += error * error;
+}
+
+double JudgementState::ErrorStatistics::getMean() const {
+	return count == 0 ? 0. : sum / count;
+}
+
+double JudgementState::ErrorStatistics::getStandardDeviation() const {
+	if (count == 0) return 0.;
+	const double mean = getMean();
+	return std::sqrt(std::max(sumOfSquares / count - mean * mean, 0.));
+}
+
+JudgementState::JudgementState(const Chart::Note *const notes, const std::size_t noteCount):
+	notes(notes), judgementIndex(notes, noteCount)
+{}
+
+bool JudgementState::apply(const ReplayEvent &event) {
+	const double time = event.time / 1000.;
+	switch (event.type) {
+		case ReplayEvent::Type::Press: {
+			pointerTable.press(event.pointerId, event.column, event.time);
+			const long noteIndex = judgementIndex.hit(event.column, time);
+			if (noteIndex != -1) errorStatistics.add(time - notes[noteIndex].time);
+			return true;
+		}
+		case ReplayEvent::Type::Move:
+			pointerTable.move(event.pointerId, event.column, event.time);
+			return true;
+		case ReplayEvent::Type::Release:
+			pointerTable.release(event.pointerId, event.time);
+			return true;
+		case ReplayEvent::Type::ReleaseAll:
+			pointerTable.releaseAll(event.time);
+			return true;
+		case ReplayEvent::Type::Advance:
+			return judgementIndex.advance(time);
+	}
+	return false;
+}
+
+void JudgementState::finish() {
+	judgementIndex.advance(std::numeric_limits<double>::infinity());
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef YUBINOBUTAI_JUDGEMENTSTATE_H
+#define YUBINOBUTAI_JUDGEMENTSTATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Chart.h"
+#include "JudgementIndex.h"
+#include "PointerTable.h"
+#include "Replay.h"
+
+// The whole of judgement, driven only by replay events, so that a recorded play comes out exactly the same when
+// applied again. Has no notion of threads or clocks.
+class JudgementState final {
+	public:
+		// Of hit times relative to the notes, in milliseconds, positive when late.
+		struct ErrorStatistics {
+			int count = 0;
+			double sum = 0., sumOfSquares = 0., min = 0., max = 0.;
+
+			void add(double error);
+			double getMean() const;
+			double getStandardDeviation() const;
+		};
+	private:
+		const Chart::Note *notes;
+		JudgementIndex judgementIndex;
+		PointerTable pointerTable;
+		ErrorStatistics errorStatistics;
+	public:
+		JudgementState(const Chart::Note *notes, std::size_t noteCount);
+		// Returns `false` for an advance that judged nothing new, which needs no recording.
+		bool apply(const ReplayEvent &event);
+		// Counts every note not hit yet as missed, for when a play is over.
+		void finish();
+		const JudgementIndex& getJudgementIndex() const {
+			return judgementIndex;
+		}
+		const PointerTable& getPointerTable() const {
+			return pointerTable;
+		}
+		const ErrorStatistics& getErrorStatistics() const {
+			return errorStatistics;
+		}
+};
+
+#endif // YUBINOBUTAI_JUDGEMENTSTATE_H
\ No newline at end of file
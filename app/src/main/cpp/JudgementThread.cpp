@@ -0,0 +1,110 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ConcurrentQueue/blockingconcurrentqueue.h>
+
+#include <audio/AudioClock.h>
+#include "Chart.h"
+#include "Replay.h"
+
+#include "JudgementThread.h"
+
+namespace {
+	// How often misses are checked for when no taps come in.
+	constexpr std::chrono::milliseconds missCheckInterval(10);
+	// Touches reach this thread a little after they happen, so misses are held off for a while to let those still
+	// land. In microseconds.
+	constexpr std::int64_t missGracePeriod = 50'000;
+} // namespace
+
+JudgementThread::JudgementThread(
+	const AudioClock &musicClock, const Chart::Note *const notes, const std::size_t noteCount, std::string replayPath
+):
+	musicClock(musicClock), judgementState(notes, noteCount), replayWriter(noteCount),
+	replayPath(std::move(replayPath)),
+	snapshots(Snapshot{std::vector<bool>(noteCount, false)}),
+	thread([this] { run(); })
+{}
+
+JudgementThread::~JudgementThread() {
+	pointerEvents.enqueue({PointerEvent::Type::Stop, -1, -1, 0});
+	thread.join();
+}
+
+void JudgementThread::setAudioOffset(const double offset) {
+	audioOffset.store(offset, std::memory_order_relaxed);
+}
+
+void JudgementThread::addPointerEvent(const PointerEvent pointerEvent) {
+	pointerEvents.enqueue(pointerEvent);
+}
+
+std::int64_t JudgementThread::toSongTime(const std::int64_t eventTime, const double offset) const {
+	// Judgement works on whole microseconds, the same as what goes into the replay.
+	return std::llround((musicClock.toStreamTime(eventTime) - offset) * 1000.);
+}
+
+void JudgementThread::run() {
+	while (true) {
+		const JudgementIndex &judgementIndex = judgementState.getJudgementIndex();
+		const int hitCount = judgementIndex.getHitCount(), missCount = judgementIndex.getMissCount();
+		const std::uint32_t heldColumns = judgementState.getPointerTable().getHeldColumns();
+		const double offset = audioOffset.load(std::memory_order_relaxed);
+		PointerEvent pointerEvent;
+		if (pointerEvents.wait_dequeue_timed(pointerEvent, missCheckInterval)) {
+			do {
+				ReplayEvent replayEvent;
+				switch (pointerEvent.type) {
+					case PointerEvent::Type::Press:
+						replayEvent.type = ReplayEvent::Type::Press;
+						break;
+					case PointerEvent::Type::Move:
+						replayEvent.type = ReplayEvent::Type::Move;
+						break;
+					case PointerEvent::Type::Release:
+						replayEvent.type = ReplayEvent::Type::Release;
+						break;
+					case PointerEvent::Type::ReleaseAll:
+						replayEvent.type = ReplayEvent::Type::ReleaseAll;
+						break;
+					case PointerEvent::Type::Stop:
+						if (!replayPath.empty()) {
+							replayWriter.addJudgements(judgementState.getJudgementIndex().getHitNotes());
+							replayWriter.save(replayPath);
+						}
+						return;
+				}
+				replayEvent.pointerId = pointerEvent.pointerId;
+				replayEvent.column = pointerEvent.column;
+				replayEvent.time = toSongTime(pointerEvent.eventTime, offset);
+				replayEvent.x = static_cast<int>(std::lround(pointerEvent.x));
+				replayEvent.y = static_cast<int>(std::lround(pointerEvent.y));
+				judgementState.apply(replayEvent);
+				replayWriter.add(replayEvent);
+			} while (pointerEvents.try_dequeue(pointerEvent));
+		}
+		const ReplayEvent advanceEvent{
+			ReplayEvent::Type::Advance, 0, -1, toSongTime(AudioClock::now(), offset) - missGracePeriod
+		};
+		// Advancing only matters for later events when it judges something, so only then is it recorded.
+		if (judgementState.apply(advanceEvent)) replayWriter.add(advanceEvent);
+		if (
+			judgementIndex.getHitCount() != hitCount || judgementIndex.getMissCount() != missCount
+			|| judgementState.getPointerTable().getHeldColumns() != heldColumns
+		) publish();
+	}
+}
+
+void JudgementThread::publish() {
+	const JudgementIndex &judgementIndex = judgementState.getJudgementIndex();
+	Snapshot &snapshot = snapshots.getWriteBuffer();
+	snapshot.hitNotes = judgementIndex.getHitNotes();
+	snapshot.hitCount = judgementIndex.getHitCount();
+	snapshot.missCount = judgementIndex.getMissCount();
+	snapshot.heldColumns = judgementState.getPointerTable().getHeldColumns();
+	snapshots.publish();
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef YUBINOBUTAI_JUDGEMENTTHREAD_H
+#define YUBINOBUTAI_JUDGEMENTTHREAD_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ConcurrentQueue/blockingconcurrentqueue.h>
+
+#include <audio/AudioClock.h>
+#include "Chart.h"
+#include "JudgementState.h"
+#include "Replay.h"
+#include "TripleBuffer.h"
+
+// Judges taps and counts misses on its own thread, so that neither waits for a frame to be rendered. Pointer events
+// are handed over as soon as they arrive, the results are published as snapshots for the renderer.
+class JudgementThread final {
+	public:
+		struct Snapshot {
+			std::vector<bool> hitNotes;
+			int hitCount = 0, missCount = 0;
+			// See `PointerTable`.
+			std::uint32_t heldColumns = 0;
+		};
+		struct PointerEvent {
+			enum class Type {Press, Move, Release, ReleaseAll, Stop};
+
+			Type type;
+			int pointerId;
+			int column; // -1 if outside of the lanes.
+			std::int64_t eventTime; // In nanoseconds of the steady clock.
+			// Screen position in pixels, recorded into the replay.
+			float x = 0.f, y = 0.f;
+		};
+	private:
+		const AudioClock &musicClock;
+		std::atomic<double> audioOffset = 0.;
+		JudgementState judgementState;
+		ReplayWriter replayWriter;
+		std::string replayPath;
+		moodycamel::BlockingConcurrentQueue<PointerEvent> pointerEvents;
+		TripleBuffer<Snapshot> snapshots;
+		std::thread thread;
+
+		std::int64_t toSongTime(std::int64_t eventTime, double offset) const;
+		void run();
+		void publish();
+	public:
+		// The clock gives the music's time, the notes must outlive this. Everything judged is recorded and saved as a
+		// replay to the given path when this is destroyed.
+		JudgementThread(
+			const AudioClock &musicClock, const Chart::Note *notes, std::size_t noteCount, std::string replayPath
+		);
+		~JudgementThread();
+		// How much later than the music clock taps land, see `Calibration`. May be called from any thread.
+		void setAudioOffset(double offset);
+		// May be called from any thread. Presses are judged as taps.
+		void addPointerEvent(PointerEvent pointerEvent);
+		// For a single reader thread. The snapshot stays valid until the next call.
+		const Snapshot& getSnapshot() {
+			return snapshots.read();
+		}
+};
+
+#endif // YUBINOBUTAI_JUDGEMENTTHREAD_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+#include <glm/ext.hpp>
+#include <glm/glm.hpp>
+
+#include "CommandList.h"
+#include "RenderQueue.h"
+
+#include "LineBatch.h"
+
+namespace {
+
+const std::string vertexShader = R"vertex(#version 300 es
+uniform mat4 uProjection;
+in vec2 inCorner;
+in vec3 inPosition;
+in vec2 inSize;
+in vec4 inColor;
+out float fragX;
+flat out float fragHalfWidth;
+flat out vec4 fragColor;
+
+void main() {
+	float halfWidth = inSize.x / 2.;
+	float x = inCorner.x * (halfWidth + 1.);
+	gl_Position = uProjection * vec4(inPosition + vec3(x, 0.0, -inCorner.y * inSize.y), 1.0);
+	fragX = x;
+	fragHalfWidth = halfWidth;
+	fragColor = inColor;
+}
+)vertex";
+
+const std::string fragmentShader = R"fragment(#version 300 es
+precision highp float;
+in float fragX;
+flat in float fragHalfWidth;
+flat in vec4 fragColor;
+out vec4 outColor;
+
+void main() {
+	float pixelSize = abs(dFdx(fragX));
+	float halfPixelSize = pixelSize / 2.;
+	outColor = vec4(fragColor.rgb, fragColor.a * clamp(
+		(min(fragHalfWidth, fragX + halfPixelSize) - max(-fragHalfWidth, fragX - halfPixelSize)) / pixelSize, 0., 1.
+	));
+}
+)fragment";
+
+// A triangle strip; X is the side of the line, Y how far along it.
+const float corners[] = {
+	-1.f, 0.f,
+	1.f, 0.f,
+	-1.f, 1.f,
+	1.f, 1.f
+};
+
+} // namespace
+
+LineBatch::LineBatch(StreamingBuffer &streamingBuffer):
+	streamingBuffer(streamingBuffer),
+	shader(std::move(Shader::loadShader("LineBatch", vertexShader, fragmentShader)))
+{
+	const auto shaderProgram = shader->getProgram();
+	uProjection = glGetUniformLocation(shaderProgram, "uProjection");
+	const GLuint inCorner = glGetAttribLocation(shaderProgram, "inCorner");
+	inPosition = glGetAttribLocation(shaderProgram, "inPosition");
+	inSize = glGetAttribLocation(shaderProgram, "inSize");
+	inColor = glGetAttribLocation(shaderProgram, "inColor");
+
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+
+	glGenBuffers(1, &cornerBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, cornerBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(inCorner);
+	glVertexAttribPointer(inCorner, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+	for (const GLuint location : {inPosition, inSize, inColor}) {
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+LineBatch::~LineBatch() {
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteBuffers(1, &cornerBuffer);
+}
+
+void LineBatch::render(RenderQueue &queue, const RenderQueue::Pass pass, const glm::mat4 &matrix) {
+	draw(queue, pass, matrix, lines.data(), lines.size());
+	lines.clear();
+}
+
+void LineBatch::record(
+	CommandList &list, const RenderQueue::Pass pass, const glm::mat4 &matrix, const Line *const recordedLines,
+	const std::size_t count
+) {
+	list.record<RecordedDraw, submitRecordedDraw>({this, pass, matrix, recordedLines, count});
+}
+
+void LineBatch::submitRecordedDraw(const RecordedDraw &recordedDraw, RenderQueue &queue) {
+	recordedDraw.batch->draw(
+		queue, recordedDraw.pass, recordedDraw.matrix, recordedDraw.lines, recordedDraw.count
+	);
+}
+
+void LineBatch::draw(
+	RenderQueue &queue, const RenderQueue::Pass pass, const glm::mat4 &matrix, const Line *const drawnLines,
+	const std::size_t count
+) {
+	if (count == 0) return;
+	const auto writtenOffset = streamingBuffer.write(drawnLines, count * sizeof(Line));
+	if (!writtenOffset) return;
+	const auto offset = static_cast<std::uintptr_t>(*writtenOffset);
+	RenderQueue::Draw instancedDraw{GL_TRIANGLE_STRIP, 4};
+	instancedDraw.instanceCount = static_cast<GLsizei>(count);
+	queue.add(
+		pass, 0.f, shader->getProgram(), vertexArray, 0,
+		{{uProjection, GlStateCache::UniformType::Matrix4, glm::value_ptr(matrix)}},
+		streamingBuffer.getBuffer(),
+		{
+			{inPosition, 3, sizeof(Line), offset + offsetof(Line, position)},
+			{inSize, 2, sizeof(Line), offset + offsetof(Line, width)},
+			{inColor, 4, sizeof(Line), offset + offsetof(Line, color)}
+		},
+		instancedDraw
+	);
+}
\ No newline at end of file
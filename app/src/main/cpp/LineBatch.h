@@ -0,0 +1,65 @@
+#ifndef YUBINOBUTAI_LINEBATCH_H
+#define YUBINOBUTAI_LINEBATCH_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <GLES3/gl3.h>
+#include <glm/glm.hpp>
+
+#include "BasicData.h"
+#include "CommandList.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "StreamingBuffer.h"
+
+// Draws the same anti-aliased lines as `TestLine`, but collects them and draws all of them with one instanced call.
+// Each line is a quad lying on the XZ plane, starting at its position and running `height` units towards -Z.
+class LineBatch final {
+	public:
+		struct Line {
+			glm::vec3 position;
+			float width, height;
+			Vector4 color;
+		};
+	private:
+		struct RecordedDraw {
+			LineBatch *batch;
+			RenderQueue::Pass pass;
+			glm::mat4 matrix;
+			const Line *lines;
+			std::size_t count;
+		};
+
+		StreamingBuffer &streamingBuffer;
+		std::unique_ptr<Shader> shader;
+		GLint uProjection;
+		GLuint inPosition, inSize, inColor;
+		GLuint vertexArray = 0, cornerBuffer = 0;
+		std::vector<Line> lines;
+
+		static void submitRecordedDraw(const RecordedDraw &recordedDraw, RenderQueue &queue);
+		void draw(
+			RenderQueue &queue, RenderQueue::Pass pass, const glm::mat4 &matrix, const Line *drawnLines,
+			std::size_t count
+		);
+	public:
+		explicit LineBatch(StreamingBuffer &streamingBuffer);
+		LineBatch(const LineBatch&) = delete;
+		LineBatch& operator=(const LineBatch&) = delete;
+		~LineBatch();
+		void add(const glm::vec3 &position, float width, float height, Vector4 color) {
+			lines.push_back({position, width, height, color});
+		}
+		// Adds a draw of the lines added since the last call, all under the same matrix, to the queue.
+		void render(RenderQueue &queue, RenderQueue::Pass pass, const glm::mat4 &matrix);
+		// The same from any thread, for lines made there. They must stay around until the list is submitted, e.g. by
+		// living in its arena.
+		void record(
+			CommandList &list, RenderQueue::Pass pass, const glm::mat4 &matrix, const Line *recordedLines,
+			std::size_t count
+		);
+};
+
+#endif // YUBINOBUTAI_LINEBATCH_H
\ No newline at end of file
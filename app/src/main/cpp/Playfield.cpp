@@ -0,0 +1,64 @@
+#include <cstddef>
+
+#include <glm/ext.hpp>
+#include <glm/glm.hpp>
+
+#include "Chart.h"
+#include "CommandList.h"
+#include "FrameArena.h"
+#include "LineBatch.h"
+#include "RenderQueue.h"
+
+#include "Playfield.h"
+
+Playfield::Playfield(const Chart &chart):
+	notes(chart.getNotes()), noteCount(chart.getNoteCount()),
+	timingMap(chart.getSpeedChanges(), chart.getSpeedChangeCount()), noteDistances(noteCount)
+{
+	std::size_t cursor = 0;
+	for (std::size_t i = 0; i != noteCount; ++i) noteDistances[i] = timingMap.getDistance(notes[i].time, cursor);
+}
+
+glm::mat4 Playfield::getCamera(const float width, const float height) {
+	return glm::translate(
+		glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.f, 1.f, 0.f))
+			* glm::scale(glm::identity<glm::mat4>(), glm::vec3(1.f, 2.f, 1.f))
+			* glm::perspectiveFov<float>(glm::radians(70.f), width, height * 2.f, 0.01f, viewDistance),
+		glm::vec3(0.f, -4.f, -7.f)
+	);
+}
+
+void Playfield::advanceFirstNote(std::size_t &firstNote, const double time) const {
+	const double minVisibleTime = time - trailingTime;
+	while (firstNote != noteCount && notes[firstNote].time < minVisibleTime) ++firstNote;
+}
+
+void Playfield::record(CommandList &list, LineBatch &lineBatch, const View &view) const {
+	// Distances never decrease along the chart, so everything past the first note beyond the far plane is too.
+	std::size_t endNote = view.firstNote;
+	if (view.hitNotes) {
+		const double maxVisibleDistance = view.distance + viewDistance / scrollSpeed;
+		while (endNote != noteCount && noteDistances[endNote] < maxVisibleDistance) ++endNote;
+	}
+	constexpr std::size_t laneLineCount = 15;
+	LineBatch::Line *const lines = list.getArena().allocateArray<LineBatch::Line>(
+		laneLineCount + 1 + (endNote - view.firstNote)
+	);
+	LineBatch::Line *line = lines;
+	for (int i = -2; i != 3; ++i) *line++ = {glm::vec3(i, 0.f, 7.f), 0.005f, viewDistance, {1.f, 1.f, 1.f, 0.7f}};
+	for (int i = -3; i != 3; ++i) *line++ = {glm::vec3(i + 0.5f, 0.f, 0.f), 0.005f, 0.5f, {1.f, 1.f, 1.f, 0.7f}};
+	*line++ = {glm::vec3(0.f, 0.f, 0.f), 6.f, 0.01f, {1.f, 1.f, 1.f, 1.f}};
+	*line++ = {glm::vec3(0.f, 0.f, -0.5f), 6.f, 0.01f, {1.f, 1.f, 1.f, 1.f}};
+	*line++ = {glm::vec3(-3.f, 0.f, 7.f), 0.01f, viewDistance, {1.f, 1.f, 1.f, 1.f}};
+	*line++ = {glm::vec3(3.f, 0.f, 7.f), 0.01f, viewDistance, {1.f, 1.f, 1.f, 1.f}};
+	if (view.isFlashing) *line++ = {glm::vec3(0.f, 0.f, 0.25f), 6.f, 0.5f, {1.f, 1.f, 0.f, 1.f}};
+	for (std::size_t i = view.firstNote; i != endNote; ++i) {
+		if (!(*view.hitNotes)[i]) *line++ = {
+			glm::vec3(notes[i].position / 2.f - 2.25f, 0.f, (view.distance - noteDistances[i]) * scrollSpeed),
+			1.5f, 0.5f, {1.f, 1.f, 0.f, 1.f}
+		};
+	}
+	lineBatch.record(
+		list, RenderQueue::Pass::Scene, view.camera, lines, static_cast<std::size_t>(line - lines)
+	);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef YUBINOBUTAI_PLAYFIELD_H
+#define YUBINOBUTAI_PLAYFIELD_H
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Chart.h"
+#include "CommandList.h"
+#include "LineBatch.h"
+#include "TimingMap.h"
+
+// The 3D part of a frame: the lanes, the judgement line and the notes scrolling towards it. It only needs OpenGL ES 3,
+// so that tools/RenderRunner can draw it on the desktop the same as the game does.
+class Playfield final {
+	public:
+		// The far plane, which also bounds how far ahead notes are drawn.
+		static constexpr float viewDistance = 1000.f;
+		// World units the notes move per millisecond at the base speed.
+		static constexpr double scrollSpeed = 15. / 1000.;
+		// How long notes stay in sight after their time.
+		static constexpr double trailingTime = 200.;
+
+		// What is drawn in a frame.
+		struct View {
+			glm::mat4 camera;
+			// Scroll distance at the frame.
+			double distance = 0.;
+			// Notes before this are out of sight, see `advanceFirstNote`.
+			std::size_t firstNote = 0;
+			// Which notes were hit and are hidden. Null draws no notes at all.
+			const std::vector<bool> *hitNotes = nullptr;
+			// The calibration flash on the judgement line.
+			bool isFlashing = false;
+		};
+	private:
+		const Chart::Note *notes;
+		std::size_t noteCount;
+		TimingMap timingMap;
+		// Scroll distance of each note.
+		std::vector<double> noteDistances;
+	public:
+		// The chart must outlive this.
+		explicit Playfield(const Chart &chart);
+		static glm::mat4 getCamera(float width, float height);
+		const TimingMap& getTimingMap() const {
+			return timingMap;
+		}
+		// Moves the index past the notes gone out of sight at the time. Times must not decrease.
+		void advanceFirstNote(std::size_t &firstNote, double time) const;
+		// Records the lines of the view into the list's arena, so this may run on any thread.
+		void record(CommandList &list, LineBatch &lineBatch, const View &view) const;
+};
+
+#endif // YUBINOBUTAI_PLAYFIELD_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <cstdint>
+
+#include "JudgementIndex.h"
+
+#include "PointerTable.h"
+
+namespace {
+	std::uint32_t toColumnMask(const int column) {
+		return column >= 0 && column < JudgementIndex::columnCount ? std::uint32_t(1) << column : 0;
+	}
+
+	int toColumn(const std::uint32_t columnMask) {
+		return __builtin_ctz(columnMask);
+	}
+} // namespace
+
+void PointerTable::setColumnMask(Pointer &pointer, const std::uint32_t columnMask) {
+	if (pointer.columnMask == columnMask) return;
+	// Each pointer covers at most one column, so this is a constant amount of work.
+	if (pointer.columnMask != 0) {
+		const int column = toColumn(pointer.columnMask);
+		if (--columnPointerCounts[column] == 0) heldColumns &= ~pointer.columnMask;
+	}
+	if (columnMask != 0) {
+		++columnPointerCounts[toColumn(columnMask)];
+		heldColumns |= columnMask;
+	}
+	pointer.columnMask = columnMask;
+}
+
+void PointerTable::press(const int pointerId, const int column, const std::int64_t eventTime) {
+	if (pointerId < 0 || pointerId >= maxPointerCount) return;
+	Pointer &pointer = pointers[pointerId];
+	pointer.isDown = true;
+	pointer.lastEventTime = eventTime;
+	setColumnMask(pointer, toColumnMask(column));
+}
+
+void PointerTable::move(const int pointerId, const int column, const std::int64_t eventTime) {
+	if (pointerId < 0 || pointerId >= maxPointerCount) return;
+	Pointer &pointer = pointers[pointerId];
+	if (!pointer.isDown || eventTime < pointer.lastEventTime) return;
+	pointer.lastEventTime = eventTime;
+	setColumnMask(pointer, toColumnMask(column));
+}
+
+void PointerTable::release(const int pointerId, const std::int64_t eventTime) {
+	if (pointerId < 0 || pointerId >= maxPointerCount) return;
+	Pointer &pointer = pointers[pointerId];
+	pointer.isDown = false;
+	pointer.lastEventTime = eventTime;
+	setColumnMask(pointer, 0);
+}
+
+void PointerTable::releaseAll(const std::int64_t eventTime) {
+	for (int i = 0; i != maxPointerCount; ++i) if (pointers[i].isDown) release(i, eventTime);
+}
\ No newline at end of file
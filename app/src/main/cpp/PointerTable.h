@@ -0,0 +1,41 @@
+#ifndef YUBINOBUTAI_POINTERTABLE_H
+#define YUBINOBUTAI_POINTERTABLE_H
+
+#include <cstdint>
+
+#include "JudgementIndex.h"
+
+// Tracks every pointer that is down and the column it is over, indexed directly by pointer ID. The set of held
+// columns is kept as a bitmask, bit `i` for column `i`, and updated incrementally as pointers move between columns.
+class PointerTable final {
+	public:
+		// Android hands out pointer IDs below 32. Events for larger ones are ignored.
+		static constexpr int maxPointerCount = 32;
+	private:
+		struct Pointer {
+			bool isDown = false;
+			std::uint32_t columnMask = 0;
+			std::int64_t lastEventTime = 0;
+		};
+
+		Pointer pointers[maxPointerCount];
+		int columnPointerCounts[JudgementIndex::columnCount] = {};
+		std::uint32_t heldColumns = 0;
+
+		void setColumnMask(Pointer &pointer, std::uint32_t columnMask);
+	public:
+		// The column is -1 when the pointer is outside of the lanes.
+		void press(int pointerId, int column, std::int64_t eventTime);
+		// Samples older than the last one seen for the pointer are dropped.
+		void move(int pointerId, int column, std::int64_t eventTime);
+		void release(int pointerId, std::int64_t eventTime);
+		void releaseAll(std::int64_t eventTime);
+		std::uint32_t getHeldColumns() const {
+			return heldColumns;
+		}
+		std::uint32_t getColumnMask(const int pointerId) const {
+			return pointerId >= 0 && pointerId < maxPointerCount ? pointers[pointerId].columnMask : 0;
+		}
+};
+
+#endif // YUBINOBUTAI_POINTERTABLE_H
\ No newline at end of file
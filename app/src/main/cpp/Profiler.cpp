@@ -0,0 +1,231 @@
+#ifdef YUBINOBUTAI_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+// Needs the core declarations first.
+#include <GLES2/gl2ext.h>
+
+#include "AndroidOut.h"
+#include "Utility.h"
+
+#include "Profiler.h"
+
+namespace {
+	// Frames a timer query gets to finish in before its slot comes around again.
+	constexpr int queryLatency = 4;
+
+	std::mutex zoneMutex;
+	const char *zoneNames[Profiler::maxZoneCount];
+	std::atomic<int> zoneCount = 0;
+	// Nanoseconds in the current frame.
+	std::atomic<std::int64_t> zoneTimes[Profiler::maxZoneCount];
+
+	const char *gpuZoneNames[Profiler::maxGpuZoneCount];
+	int gpuZoneCount = 0;
+	// The extension's result query, the rest of it is core in OpenGL ES 3.0. Null without the extension.
+	PFNGLGETQUERYOBJECTUI64VEXTPROC getQueryObjectui64v = nullptr;
+	GLuint queries[Profiler::maxGpuZoneCount][queryLatency] = {};
+	bool isQueryPending[Profiler::maxGpuZoneCount][queryLatency] = {};
+	int querySlot = 0;
+
+	Profiler::FrameRecord history[Profiler::historySize];
+	// Where the next frame goes.
+	int historyIndex = 0;
+	int recordedFrameCount = 0;
+	std::chrono::steady_clock::time_point lastFrameEnd;
+
+	float toMilliseconds(const double nanoseconds) {
+		return static_cast<float>(nanoseconds / 1e6);
+	}
+} // namespace
+
+int Profiler::addZone(const char *const name) {
+	const std::lock_guard<std::mutex> lock(zoneMutex);
+	const int zone = zoneCount.load(std::memory_order_relaxed);
+	if (zone == maxZoneCount) {
+		aout << "Too many profiler zones, " << name << " isn't recorded" << std::endl;
+		return -1;
+	}
+	zoneNames[zone] = name;
+	zoneCount.store(zone + 1, std::memory_order_release);
+	return zone;
+}
+
+int Profiler::addGpuZone(const char *const name) {
+	if (gpuZoneCount == maxGpuZoneCount) {
+		aout << "Too many GPU profiler zones, " << name << " isn't recorded" << std::endl;
+		return -1;
+	}
+	gpuZoneNames[gpuZoneCount] = name;
+	return gpuZoneCount++;
+}
+
+Profiler::Scope::~Scope() {
+	if (zone < 0) return;
+	zoneTimes[zone].fetch_add(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+		std::memory_order_relaxed
+	);
+}
+
+Profiler::GpuScope::GpuScope(const int zone): zone(zone) {
+	// A query still in flight from `queryLatency` frames ago can't be reused, that frame goes without.
+	isTiming = getQueryObjectui64v && zone >= 0 && !isQueryPending[zone][querySlot];
+	if (isTiming) glBeginQuery(GL_TIME_ELAPSED_EXT, queries[zone][querySlot]);
+}
+
+Profiler::GpuScope::~GpuScope() {
+	if (!isTiming) return;
+	glEndQuery(GL_TIME_ELAPSED_EXT);
+	isQueryPending[zone][querySlot] = true;
+}
+
+void Profiler::initializeGpu() {
+	lastFrameEnd = std::chrono::steady_clock::now();
+	if (!Utility::hasGlExtension("GL_EXT_disjoint_timer_query")) {
+		aout << "Profiler: no GPU timer queries" << std::endl;
+		return;
+	}
+	getQueryObjectui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+		eglGetProcAddress("glGetQueryObjectui64vEXT")
+	);
+	glGenQueries(maxGpuZoneCount * queryLatency, &queries[0][0]);
+}
+
+void Profiler::shutdownGpu() {
+	if (!getQueryObjectui64v) return;
+	glDeleteQueries(maxGpuZoneCount * queryLatency, &queries[0][0]);
+	std::fill(&isQueryPending[0][0], &isQueryPending[0][0] + maxGpuZoneCount * queryLatency, false);
+	getQueryObjectui64v = nullptr;
+}
+
+void Profiler::endFrame() {
+	FrameRecord &frame = history[historyIndex];
+	const auto now = std::chrono::steady_clock::now();
+	frame.frameTime = toMilliseconds(std::chrono::duration<double, std::nano>(now - lastFrameEnd).count());
+	lastFrameEnd = now;
+	for (int zone = 0; zone != maxZoneCount; ++zone)
+		frame.zoneTimes[zone] = toMilliseconds(zoneTimes[zone].exchange(0, std::memory_order_relaxed));
+
+	std::fill(std::begin(frame.gpuZoneTimes), std::end(frame.gpuZoneTimes), -1.f);
+	if (getQueryObjectui64v) {
+		// Set when something like a frequency change made the timings meaningless, results in flight are dropped.
+		GLint isDisjoint = GL_FALSE;
+		glGetIntegerv(GL_GPU_DISJOINT_EXT, &isDisjoint);
+		for (int zone = 0; zone != gpuZoneCount; ++zone) for (int slot = 0; slot != queryLatency; ++slot) {
+			if (!isQueryPending[zone][slot]) continue;
+			GLuint isAvailable = GL_FALSE;
+			glGetQueryObjectuiv(queries[zone][slot], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+			if (!isAvailable) continue;
+			GLuint64 time = 0;
+			getQueryObjectui64v(queries[zone][slot], GL_QUERY_RESULT, &time);
+			isQueryPending[zone][slot] = false;
+			if (!isDisjoint) frame.gpuZoneTimes[zone] = std::max(frame.gpuZoneTimes[zone], 0.f)
+				+ toMilliseconds(static_cast<double>(time));
+		}
+		querySlot = (querySlot + 1) % queryLatency;
+	}
+
+	historyIndex = (historyIndex + 1) % historySize;
+	recordedFrameCount = std::min(recordedFrameCount + 1, historySize);
+}
+
+int Profiler::getZoneCount() {
+	return zoneCount.load(std::memory_order_acquire);
+}
+
+const char* Profiler::getZoneName(const int zone) {
+	return zoneNames[zone];
+}
+
+int Profiler::getGpuZoneCount() {
+	return gpuZoneCount;
+}
+
+const char* Profiler::getGpuZoneName(const int zone) {
+	return gpuZoneNames[zone];
+}
+
+int Profiler::getFrameCount() {
+	return recordedFrameCount;
+}
+
+const Profiler::FrameRecord& Profiler::getFrame(const int age) {
+	return history[(historyIndex - 1 - age + historySize * 2) % historySize];
+}
+
+std::string Profiler::getSummary(const int topZoneCount) {
+	const int frameCount = getFrameCount();
+	if (!frameCount) return {};
+	float frameTimeSum = 0.f, worstFrameTime = 0.f;
+	float zoneSums[maxZoneCount] = {}, gpuZoneSums[maxGpuZoneCount] = {};
+	int gpuZoneFrameCounts[maxGpuZoneCount] = {};
+	for (int age = 0; age != frameCount; ++age) {
+		const FrameRecord &frame = getFrame(age);
+		frameTimeSum += frame.frameTime;
+		worstFrameTime = std::max(worstFrameTime, frame.frameTime);
+		for (int zone = 0; zone != maxZoneCount; ++zone) zoneSums[zone] += frame.zoneTimes[zone];
+		for (int zone = 0; zone != maxGpuZoneCount; ++zone) if (frame.gpuZoneTimes[zone] >= 0.f) {
+			gpuZoneSums[zone] += frame.gpuZoneTimes[zone];
+			++gpuZoneFrameCounts[zone];
+		}
+	}
+
+	char line[128];
+	std::snprintf(
+		line, sizeof(line), "Frame: %.2f ms, worst %.2f ms", frameTimeSum / frameCount, worstFrameTime
+	);
+	std::string summary = line;
+	for (int zone = 0; zone != gpuZoneCount; ++zone) if (gpuZoneFrameCounts[zone]) {
+		std::snprintf(
+			line, sizeof(line), "\n%s: %.2f ms", gpuZoneNames[zone], gpuZoneSums[zone] / gpuZoneFrameCounts[zone]
+		);
+		summary += line;
+	}
+	int zones[maxZoneCount];
+	const int registeredZoneCount = getZoneCount();
+	for (int zone = 0; zone != registeredZoneCount; ++zone) zones[zone] = zone;
+	const int shownZoneCount = std::min(topZoneCount, registeredZoneCount);
+	std::partial_sort(
+		zones, zones + shownZoneCount, zones + registeredZoneCount, [&](const int first, const int second) {
+			return zoneSums[first] > zoneSums[second];
+		}
+	);
+	for (int i = 0; i != shownZoneCount; ++i) {
+		std::snprintf(line, sizeof(line), "\n%s: %.2f ms", zoneNames[zones[i]], zoneSums[zones[i]] / frameCount);
+		summary += line;
+	}
+	return summary;
+}
+
+bool Profiler::dump(const std::string &path) {
+	std::ofstream stream(path);
+	stream << "frame_ms";
+	const int registeredZoneCount = getZoneCount();
+	for (int zone = 0; zone != registeredZoneCount; ++zone) stream << ',' << zoneNames[zone];
+	for (int zone = 0; zone != gpuZoneCount; ++zone) stream << ',' << gpuZoneNames[zone];
+	stream << '\n';
+	for (int age = getFrameCount() - 1; age >= 0; --age) {
+		const FrameRecord &frame = getFrame(age);
+		stream << frame.frameTime;
+		for (int zone = 0; zone != registeredZoneCount; ++zone) stream << ',' << frame.zoneTimes[zone];
+		// Empty for frames without a result.
+		for (int zone = 0; zone != gpuZoneCount; ++zone) {
+			stream << ',';
+			if (frame.gpuZoneTimes[zone] >= 0.f) stream << frame.gpuZoneTimes[zone];
+		}
+		stream << '\n';
+	}
+	return static_cast<bool>(stream);
+}
+
+#endif // YUBINOBUTAI_PROFILER
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef YUBINOBUTAI_PROFILER_H
+#define YUBINOBUTAI_PROFILER_H
+
+#include <chrono>
+#include <string>
+
+/*
+	Frame profiler, only built with `YUBINOBUTAI_PROFILER`. Otherwise zones cost nothing and the rest isn't there.
+
+	Code marks what it wants timed with a zone, registered once per site and timed by a `Scope`:
+
+		static const int zone = Profiler::addZone("Text layout");
+		const Profiler::Scope scope(zone);
+
+	Scopes may run on any thread and add up within a frame. `endFrame` files the totals into a ring of the last
+	`historySize` frames. GPU passes are timed the same way with `GpuScope`s, where `EXT_disjoint_timer_query` is
+	available; their results come in a few frames late and are filed under the frame they arrive in.
+*/
+namespace Profiler {
+	constexpr int maxZoneCount = 32;
+	constexpr int maxGpuZoneCount = 4;
+	constexpr int historySize = 240;
+
+#ifdef YUBINOBUTAI_PROFILER
+	struct FrameRecord {
+		// Since the previous frame ended, in milliseconds like the rest.
+		float frameTime = 0.f;
+		float zoneTimes[maxZoneCount] = {};
+		// Negative when no result arrived.
+		float gpuZoneTimes[maxGpuZoneCount] = {};
+	};
+
+	// Thread safe. Zones past `maxZoneCount` aren't recorded.
+	int addZone(const char *name);
+	// GL thread only.
+	int addGpuZone(const char *name);
+
+	class Scope final {
+		private:
+			int zone;
+			std::chrono::steady_clock::time_point start;
+		public:
+			explicit Scope(const int zone): zone(zone), start(std::chrono::steady_clock::now()) {}
+			~Scope();
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+	};
+	// GL thread only, and not nested: timer queries can't overlap.
+	class GpuScope final {
+		private:
+			int zone;
+			bool isTiming;
+		public:
+			explicit GpuScope(int zone);
+			~GpuScope();
+			GpuScope(const GpuScope&) = delete;
+			GpuScope& operator=(const GpuScope&) = delete;
+	};
+
+	// With the context current, before and after any `GpuScope`.
+	void initializeGpu();
+	void shutdownGpu();
+	// On the GL thread, once every scope of the frame is done.
+	void endFrame();
+
+	int getZoneCount();
+	const char* getZoneName(int zone);
+	int getGpuZoneCount();
+	const char* getGpuZoneName(int zone);
+	// How many frames the history holds.
+	int getFrameCount();
+	// 0 is the latest frame.
+	const FrameRecord& getFrame(int age);
+	// Average frame time and the slowest zones over the history, one per line.
+	std::string getSummary(int topZoneCount);
+	// Writes the history as CSV, oldest frame first.
+	bool dump(const std::string &path);
+#else
+	constexpr int addZone(const char*) {
+		return 0;
+	}
+	constexpr int addGpuZone(const char*) {
+		return 0;
+	}
+
+	class Scope final {
+		public:
+			explicit Scope(int) {}
+	};
+	class GpuScope final {
+		public:
+			explicit GpuScope(int) {}
+	};
+#endif
+}
+
+#endif // YUBINOBUTAI_PROFILER_H
\ No newline at end of file
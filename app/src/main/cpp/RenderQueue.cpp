@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+
+#include <GLES3/gl3.h>
+
+#include "GlStateCache.h"
+#include "Profiler.h"
+
+#include "RenderQueue.h"
+
+namespace {
+	// From the top: pass, program, texture, depth, then the order of adding so that sorting is stable.
+	constexpr int passShift = 60, programShift = 48, textureShift = 36, depthShift = 20;
+	constexpr std::uint64_t nameMask = 0xFFF, depthMask = 0xFFFF, sequenceMask = 0xFFFFF;
+} // namespace
+
+void RenderQueue::add(
+	const Pass pass, const float depth, const GLuint program, const GLuint vertexArray, const GLuint texture,
+	const std::initializer_list<Uniform> drawUniforms, const GLuint vertexBuffer,
+	const std::initializer_list<VertexAttribute> vertexAttributes, const Draw &draw
+) {
+	const auto quantizedDepth = static_cast<std::uint64_t>((1.f - std::clamp(depth, 0.f, 1.f)) * depthMask);
+	const std::uint64_t key = static_cast<std::uint64_t>(pass) << passShift
+		| (program & nameMask) << programShift
+		| (texture & nameMask) << textureShift
+		| quantizedDepth << depthShift
+		| (commands.size() & sequenceMask);
+	const auto uniformStart = static_cast<std::uint32_t>(uniforms.size());
+	for (const Uniform &uniform : drawUniforms) {
+		uniforms.push_back({uniform.location, uniform.type, static_cast<std::uint32_t>(uniformValues.size())});
+		uniformValues.insert(
+			uniformValues.end(), uniform.value, uniform.value + GlStateCache::getUniformSize(uniform.type)
+		);
+	}
+	const auto attributeStart = static_cast<std::uint32_t>(attributes.size());
+	attributes.insert(attributes.end(), vertexAttributes.begin(), vertexAttributes.end());
+	commands.push_back({
+		key, program, vertexArray, texture, vertexBuffer,
+		uniformStart, static_cast<std::uint32_t>(drawUniforms.size()),
+		attributeStart, static_cast<std::uint32_t>(vertexAttributes.size()), draw
+	});
+}
+
+void RenderQueue::submit() {
+	std::sort(commands.begin(), commands.end(), [](const Command &first, const Command &second) {
+		return first.key < second.key;
+	});
+	static const int zone = Profiler::addZone("Submission");
+	const Profiler::Scope scope(zone);
+	static const int gpuZones[] = {
+		Profiler::addGpuZone("GPU background"), Profiler::addGpuZone("GPU scene"), Profiler::addGpuZone("GPU overlay")
+	};
+	// Streaming writes bind the array buffer and buffers get replaced between frames, but nothing changes while
+	// submitting.
+	stateCache.forgetVertexBuffers();
+	// Commands are sorted by pass first, so each pass is timed in one go.
+	std::optional<Profiler::GpuScope> gpuScope;
+	int pass = -1;
+	for (const Command &command : commands) {
+		if (const int commandPass = static_cast<int>(command.key >> passShift); commandPass != pass) {
+			gpuScope.reset();
+			pass = commandPass;
+			gpuScope.emplace(gpuZones[pass]);
+		}
+		stateCache.useProgram(command.program);
+		stateCache.bindVertexArray(command.vertexArray);
+		for (std::uint32_t i = command.attributeStart; i != command.attributeStart + command.attributeCount; ++i) {
+			const VertexAttribute &attribute = attributes[i];
+			stateCache.setVertexAttributePointer(
+				attribute.location, command.vertexBuffer, attribute.size, attribute.stride, attribute.offset
+			);
+		}
+		if (command.texture != 0) stateCache.bindTexture(0, command.texture);
+		for (std::uint32_t i = command.uniformStart; i != command.uniformStart + command.uniformCount; ++i) {
+			const StoredUniform &uniform = uniforms[i];
+			stateCache.setUniform(uniform.location, uniform.type, uniformValues.data() + uniform.valueOffset);
+		}
+		const Draw &draw = command.draw;
+		const auto *const indices = reinterpret_cast<const void*>(draw.indexOffset);
+		if (draw.indexType == 0) {
+			if (draw.instanceCount == 1) glDrawArrays(draw.mode, draw.first, draw.count);
+			else glDrawArraysInstanced(draw.mode, draw.first, draw.count, draw.instanceCount);
+		} else {
+			if (draw.instanceCount == 1) glDrawElements(draw.mode, draw.count, draw.indexType, indices);
+			else glDrawElementsInstanced(draw.mode, draw.count, draw.indexType, indices, draw.instanceCount);
+		}
+	}
+	drawCount += static_cast<long>(commands.size());
+	++frameCount;
+	commands.clear();
+	uniforms.clear();
+	uniformValues.clear();
+	attributes.clear();
+}
\ No newline at end of file
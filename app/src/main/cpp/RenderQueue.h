@@ -0,0 +1,88 @@
+#ifndef YUBINOBUTAI_RENDERQUEUE_H
+#define YUBINOBUTAI_RENDERQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include <GLES3/gl3.h>
+
+#include "GlStateCache.h"
+
+// Collects a frame's draws, sorts them once and issues them through a `GlStateCache`. Draws are ordered by pass,
+// then program, then texture, then depth from far to near, so consecutive draws share as much state as possible;
+// draws that tie keep the order they were added in. Vertex data has to be written when a draw is added, everything
+// else is deferred: the program, vertex array, texture, uniforms and the attribute pointers into the vertex buffer.
+// So several draws in a frame can share a vertex array with their data at different offsets. Index buffers and the
+// other vertex array state are whatever they are at submission.
+class RenderQueue final {
+	public:
+		enum class Pass : std::uint8_t {
+			Background, Scene, Overlay
+		};
+		struct Uniform {
+			GLint location;
+			GlStateCache::UniformType type;
+			const float *value;
+		};
+		// Float attributes read from the draw's vertex buffer.
+		struct VertexAttribute {
+			GLuint location;
+			GLint size;
+			GLsizei stride;
+			std::uintptr_t offset;
+		};
+		struct Draw {
+			GLenum mode;
+			GLsizei count;
+			// 0 for non-indexed draws, which start at `first`.
+			GLenum indexType = 0;
+			std::uintptr_t indexOffset = 0;
+			GLint first = 0;
+			GLsizei instanceCount = 1;
+		};
+	private:
+		struct StoredUniform {
+			GLint location;
+			GlStateCache::UniformType type;
+			std::uint32_t valueOffset;
+		};
+		struct Command {
+			std::uint64_t key;
+			GLuint program, vertexArray, texture, vertexBuffer;
+			std::uint32_t uniformStart, uniformCount, attributeStart, attributeCount;
+			Draw draw;
+		};
+
+		GlStateCache stateCache;
+		// Cleared every frame, the capacity stays.
+		std::vector<Command> commands;
+		std::vector<StoredUniform> uniforms;
+		std::vector<float> uniformValues;
+		std::vector<VertexAttribute> attributes;
+		long frameCount = 0, drawCount = 0;
+	public:
+		// Depth is 0 at the camera and 1 at the far plane. A texture of 0 leaves texture bindings alone. The vertex
+		// buffer must stay alive until submission, it's only bound if there are attributes to point into it.
+		void add(
+			Pass pass, float depth, GLuint program, GLuint vertexArray, GLuint texture,
+			std::initializer_list<Uniform> drawUniforms, GLuint vertexBuffer,
+			std::initializer_list<VertexAttribute> vertexAttributes, const Draw &draw
+		);
+		// Issues everything added since the last call.
+		void submit();
+
+		// For code that binds vertex arrays while recording, and for telling the cache about state changed elsewhere.
+		GlStateCache& getStateCache() {
+			return stateCache;
+		}
+		long getFrameCount() const {
+			return frameCount;
+		}
+		long getDrawCount() const {
+			return drawCount;
+		}
+};
+
+#endif // YUBINOBUTAI_RENDERQUEUE_H
\ No newline at end of file
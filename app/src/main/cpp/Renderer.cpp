@@ -4,7 +4,10 @@
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <sstream>
 #include <string>
@@ -24,17 +27,29 @@
 #include <oboe/Oboe.h>
 
 #include <audio/AggregateAudioStream.h>
-#include <audio/PreloadedAudioTrack.h>
+#include <audio/AudioClock.h>
+#include <audio/MetronomeAudioStream.h>
+#include <audio/RealtimeSafety.h>
+#include <audio/SampleBank.h>
 #include <audio/StreamingAudioStream.h>
+#include <audio/TriggeredAudioStream.h>
 #include <text/MemoryFont.h>
 #include <text/TextLayout.h>
 #include <text/TextRenderer.h>
 #include <text/TextRenderingString.h>
 #include "AndroidOut.h"
 #include "BasicData.h"
+#include "Benchmarks.h"
+#include "Calibration.h"
+#include "Chart.h"
+#include "CommandList.h"
+#include "JudgementThread.h"
+#include "Playfield.h"
+#include "Profiler.h"
 #include "Shader.h"
 #include "TextureAsset.h"
 #include "Utility.h"
+#include "WorkerPool.h"
 
 //! executes glGetString and outputs the result to logcat
 #define PRINT_GL_STRING(s) do { aout << #s": "<< glGetString(s) << std::endl; } while (false)
@@ -60,6 +75,43 @@
 using namespace std::string_literals;
 using namespace std::string_view_literals;
 
+namespace {
+	// Milliseconds of song time per simulation step.
+	constexpr double simulationStep = 1000. / 240.;
+	// Falling further behind than this, e.g. after a stall, skips ahead instead of catching up step by step.
+	constexpr int maxSimulationSteps = 60;
+
+	// Converts a pointer position to the horizontal world coordinate on the judgement line. Returns `false` if it's
+	// outside of the lane area.
+	bool toLaneX(
+		const float pointerX, const float pointerY, const int width, const int height, double &worldX
+	) {
+		const double
+			factor = glm::tan(glm::radians(35.)) * 7.,
+			worldY = - static_cast<double>(pointerY) / height * factor + 4.;
+		worldX = (static_cast<double>(pointerX) - width / 2.) / height * factor;
+		return glm::abs(worldX) <= 3 && glm::abs(worldY) <= 1;
+	}
+
+	// Prefers the binary chart. Failing that, converts the text chart and saves the result to `convertedPath` so it
+	// can be pulled off the device and shipped.
+	std::optional<Chart> loadChart(AAssetManager *const assetManager, const std::string &convertedPath) {
+		if (auto chart = Chart::fromAsset(assetManager, "chart.ybc")) return chart;
+		const std::unique_ptr<AAsset, void(*)(AAsset*)> textAsset(
+			AAssetManager_open(assetManager, "chart.txt", AASSET_MODE_BUFFER), AAsset_close
+		);
+		if (textAsset == nullptr) return std::nullopt;
+		std::vector<unsigned char> data;
+		if (!Chart::convertText(
+			static_cast<const char*>(AAsset_getBuffer(textAsset.get())),
+			static_cast<std::size_t>(AAsset_getLength64(textAsset.get())), data
+		)) return std::nullopt;
+		std::ofstream(convertedPath, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+		aout << "Converted chart.txt, binary chart saved to " << convertedPath << std::endl;
+		return Chart::fromData(std::move(data));
+	}
+} // namespace
+
 void Renderer::initRenderer() {
 	const auto assetManager = appData->activity->assetManager;
 
@@ -127,6 +179,9 @@ void Renderer::initRenderer() {
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glDisable(GL_CULL_FACE);
+#ifdef YUBINOBUTAI_PROFILER
+	Profiler::initializeGpu();
+#endif
 
 	fonts = {
 		minikin::FontCollection::create({
@@ -135,39 +190,83 @@ void Renderer::initRenderer() {
 			).build()}),
 		}),
 	};
-	testLine.emplace();
-	textRenderer.emplace();
+	Shader::setCacheDirectory(appData->activity->internalDataPath);
+	streamingBuffer.emplace();
+	lineBatch.emplace(*streamingBuffer);
+	textRenderer.emplace(*streamingBuffer);
+	textureLoader.emplace(assetManager, *streamingBuffer);
+	background.emplace(*textureLoader, "background.png");
+
+#ifdef YUBINOBUTAI_BENCHMARKS
+	Benchmarks::runAudioLoading(assetManager);
+	Benchmarks::runChartLoading(assetManager);
+	Benchmarks::runTextureLoading(assetManager);
+	Benchmarks::runLineRendering(*streamingBuffer);
+#endif
+
+	chart = loadChart(assetManager, appData->activity->internalDataPath + "/chart.ybc"s);
+	if (!chart) {
+		// Stays on the error message, without audio or judgement.
+		aout << "Couldn't load chart.ybc or chart.txt." << std::endl;
+		return;
+	}
+	notes = chart->getNotes();
+	noteCount = chart->getNoteCount();
+	playfield.emplace(*chart);
 
 	aggregateStream.reset(new AggregateAudioStream());
 	musicStream.reset(new StreamingAudioStream(assetManager, "Can't let go 2 (GD cut).mp3", audioDecodingThread));
-	effectTrack.reset(new PreloadedAudioTrack(assetManager, "Hit.wav"));
-	aggregateStream->play(musicStream.get());
+	sampleBank.emplace(assetManager);
+	effectTrack = sampleBank->load("Hit.wav");
+	effectStream.reset(new TriggeredAudioStream(*effectTrack));
+	aggregateStream->play(effectStream.get());
+
+	calibrationPath = appData->activity->internalDataPath + "/calibration.txt"s;
+	if (const auto savedOffsets = Calibration::load(calibrationPath)) {
+		calibrationOffsets = *savedOffsets;
+		aggregateStream->play(musicStream.get());
+	} else {
+		calibration.emplace();
+		metronomeStream.reset(new MetronomeAudioStream(
+			*effectTrack, calibration->getBeatInterval(), calibration->getClickCount()
+		));
+		isCalibrating = true;
+		metronomeHandle = aggregateStream->play(metronomeStream.get());
+	}
+	aout << "Calibration offsets: audio " << calibrationOffsets.audio
+		<< " ms, visual " << calibrationOffsets.visual << " ms" << std::endl;
 
 	oboe::AudioStreamBuilder audioStreamBuilder;
 	audioStreamBuilder.setDirection(oboe::Direction::Output);
 	audioStreamBuilder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
 	audioStreamBuilder.setSharingMode(oboe::SharingMode::Exclusive);
-	audioStreamBuilder.setFormat(oboe::AudioFormat::Float);
+	// Take whatever format the low latency path uses natively so that Oboe doesn't add a conversion stage.
+	audioStreamBuilder.setFormat(oboe::AudioFormat::Unspecified);
 	audioStreamBuilder.setFormatConversionAllowed(true);
 	audioStreamBuilder.setSampleRate(48000);
 	audioStreamBuilder.setSampleRateConversionQuality(oboe::SampleRateConversionQuality::Medium);
 	audioStreamBuilder.setChannelCount(oboe::ChannelCount::Stereo);
 	audioStreamBuilder.setDataCallback(this);
 	audioStreamBuilder.openStream(audioStream);
+	const auto nativeFormat = audioStream->getFormat();
+	if (nativeFormat != oboe::AudioFormat::Float && nativeFormat != oboe::AudioFormat::I16) {
+		audioStream->close();
+		audioStreamBuilder.setFormat(oboe::AudioFormat::Float);
+		audioStreamBuilder.openStream(audioStream);
+	}
+	if (audioStream->getFormat() == oboe::AudioFormat::I16)
+		mixBuffer.resize(audioStream->getBufferCapacityInFrames() * 2);
+	aggregateStream->reserve(audioStream->getBufferCapacityInFrames());
+	aout << "Audio output format: " << oboe::convertToText(nativeFormat)
+		<< " -> " << oboe::convertToText(audioStream->getFormat()) << std::endl;
+	// Give the judgement thread a starting point until the audio thread takes over.
+	musicClock.update(0., AudioClock::now());
 	audioStream->requestStart();
 
-	const auto chartAsset = AAssetManager_open(assetManager, "chart.txt", AASSET_MODE_BUFFER);
-	const char *const chartBuffer = static_cast<const char*>(AAsset_getBuffer(chartAsset));
-	std::istringstream chartStream(std::string(chartBuffer, AAsset_getLength(chartAsset)));
-	while (true) {
-		Note note;
-		chartStream >> note.time;
-		if (!chartStream) break;
-		chartStream >> note.position;
-		notes.push_back(note);
-	}
-	nextNote = notes.begin();
-	AAsset_close(chartAsset);
+	judgementThread.reset(new JudgementThread(
+		musicClock, notes, noteCount, appData->activity->internalDataPath + "/replay.ynr"s
+	));
+	judgementThread->setAudioOffset(calibrationOffsets.audio);
 
 	/*
 	aout << "System fonts:" << std::endl;
@@ -193,10 +292,85 @@ void Renderer::updateRenderArea() {
 	if (newWidth != width || newHeight != height) {
 		width = newWidth;
 		height = newHeight;
+		inputWidth = width;
+		inputHeight = height;
 		glViewport(0, 0, width, height);
 	}
 }
 
+void Renderer::finishCalibration() {
+	calibrationOffsets = calibration->getOffsets();
+	Calibration::save(calibrationPath, calibrationOffsets);
+	aout << "Calibrated offsets: audio " << calibrationOffsets.audio
+		<< " ms, visual " << calibrationOffsets.visual << " ms" << std::endl;
+	calibration.reset();
+	aggregateStream->stop(metronomeHandle);
+	isCalibrating = false;
+	judgementThread->setAudioOffset(calibrationOffsets.audio);
+	aggregateStream->play(musicStream.get());
+}
+
+void Renderer::handleEarlyInput(const GameActivityMotionEvent &motionEvent) {
+	// Hit sounds would throw off the player during calibration, and there are no notes to judge then.
+	if (isCalibrating || !chart) return;
+	const int currentWidth = inputWidth, currentHeight = inputHeight;
+	if (currentHeight <= 0) return;
+	const auto toColumn = [currentWidth, currentHeight](const float pointerX, const float pointerY) {
+		double worldX;
+		return toLaneX(pointerX, pointerY, currentWidth, currentHeight, worldX)
+			? static_cast<int>((worldX + 3.) * 2.)
+			: -1;
+	};
+	using PointerEvent = JudgementThread::PointerEvent;
+	const auto pointerIndex
+		= (motionEvent.action & AMOTION_EVENT_ACTION_POINTER_INDEX_MASK) >> AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT;
+	const auto &actionPointer = motionEvent.pointers[pointerIndex];
+	switch (motionEvent.action & AMOTION_EVENT_ACTION_MASK) {
+		case AMOTION_EVENT_ACTION_DOWN:
+		case AMOTION_EVENT_ACTION_POINTER_DOWN: {
+			const float
+				x = GameActivityPointerAxes_getX(&actionPointer), y = GameActivityPointerAxes_getY(&actionPointer);
+			const int column = toColumn(x, y);
+			if (column != -1) effectStream->trigger(motionEvent.eventTime);
+			judgementThread->addPointerEvent({
+				PointerEvent::Type::Press, actionPointer.id, column, motionEvent.eventTime, x, y
+			});
+			break;
+		}
+		case AMOTION_EVENT_ACTION_MOVE:
+			// Batched samples come first, oldest to newest.
+			for (int historyIndex = 0; historyIndex != motionEvent.historySize; ++historyIndex) {
+				const std::int64_t eventTime = motionEvent.historicalEventTimesNanos[historyIndex];
+				for (std::uint32_t i = 0; i != motionEvent.pointerCount; ++i) {
+					const float
+						x = GameActivityMotionEvent_getHistoricalX(&motionEvent, i, historyIndex),
+						y = GameActivityMotionEvent_getHistoricalY(&motionEvent, i, historyIndex);
+					judgementThread->addPointerEvent({
+						PointerEvent::Type::Move, motionEvent.pointers[i].id, toColumn(x, y), eventTime, x, y
+					});
+				}
+			}
+			for (std::uint32_t i = 0; i != motionEvent.pointerCount; ++i) {
+				const auto &pointer = motionEvent.pointers[i];
+				const float x = GameActivityPointerAxes_getX(&pointer), y = GameActivityPointerAxes_getY(&pointer);
+				judgementThread->addPointerEvent({
+					PointerEvent::Type::Move, pointer.id, toColumn(x, y), motionEvent.eventTime, x, y
+				});
+			}
+			break;
+		case AMOTION_EVENT_ACTION_UP:
+		case AMOTION_EVENT_ACTION_POINTER_UP:
+			judgementThread->addPointerEvent({
+				PointerEvent::Type::Release, actionPointer.id, -1, motionEvent.eventTime,
+				GameActivityPointerAxes_getX(&actionPointer), GameActivityPointerAxes_getY(&actionPointer)
+			});
+			break;
+		case AMOTION_EVENT_ACTION_CANCEL:
+			judgementThread->addPointerEvent({PointerEvent::Type::ReleaseAll, -1, -1, motionEvent.eventTime});
+			break;
+	}
+}
+
 void Renderer::handleInput() {
 	// handle all queued inputs
 	auto *inputBuffer = android_app_swap_input_buffers(appData);
@@ -224,7 +398,8 @@ void Renderer::handleInput() {
 		switch (action & AMOTION_EVENT_ACTION_MASK) {
 			case AMOTION_EVENT_ACTION_DOWN:
 			case AMOTION_EVENT_ACTION_POINTER_DOWN: {
-				onTap(x, y);
+				// Outside of calibration, taps are judged in `handleEarlyInput` already.
+				if (calibration) calibration->addTap(metronomeClock.toStreamTime(motionEvent.eventTime));
 				//aout << "(" << pointer.id << ", " << x << ", " << y << ") Pointer down";
 				break;
 			}
@@ -285,29 +460,6 @@ void Renderer::handleInput() {
 	android_app_clear_key_events(inputBuffer);
 }
 
-void Renderer::onTap(const float pointerX, const float pointerY) {
-	const double
-		factor = glm::tan(glm::radians(35.)) * 7.,
-		worldX = (static_cast<double>(pointerX) - width / 2.) / height * factor,
-		worldY = - static_cast<double>(pointerY) / height * factor + 4.;
-	if (glm::abs(worldX) > 3 || glm::abs(worldY) > 1) return;
-
-	auto effect = std::make_unique<PreloadedAudioStream>(*effectTrack);
-	const auto handle = aggregateStream->play(effect.get());
-	playingEffects.push_back({std::move(effect), handle});
-
-	const int column = static_cast<int>((worldX + 3.) * 2.);
-	for (auto iterator = nextNote; iterator != notes.end(); ++iterator) {
-		auto &note = *iterator;
-		if (note.time - time > 100.) break;
-		if (!note.hit && time - note.time < 100. && column >= note.position && column < note.position + 3) {
-			note.hit = true;
-			++hitCount;
-			return;
-		}
-	}
-}
-
 void Renderer::render() {
 	// Check to see if the surface has changed size. This is necessary to do every frame when
 	// using immersive mode as you'll get no other notification that your renderable area has
@@ -316,87 +468,241 @@ void Renderer::render() {
 
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	playingEffects.resize(std::remove_if(
-		playingEffects.begin(), playingEffects.end(),
-		[this](const auto &effect) { return !aggregateStream->isPlaying(effect.handle); }
-	) - playingEffects.begin());
+	frame.view.camera = Playfield::getCamera(static_cast<float>(width), static_cast<float>(height));
+	frame.view.isFlashing = false;
+	frame.view.hitNotes = nullptr;
+	frame.judgement = nullptr;
+	frame.statusText = chart ? "" : "Couldn't load the chart.";
+	// Streams retired during calibration need reclaiming too, so not only when simulating.
+	if (aggregateStream) aggregateStream->collectGarbage();
+	if (calibration) {
+		const double calibrationTime = metronomeClock.toStreamTime(AudioClock::now());
+		const auto phase = calibration->getPhase(calibrationTime);
+		if (phase == Calibration::Phase::Done) {
+			finishCalibration();
+		} else {
+			frame.view.isFlashing = calibration->isFlashing(calibrationTime);
+			frame.statusText = phase == Calibration::Phase::Audio
+				? "Calibrating: tap along with the clicks."
+				: "Calibrating: tap when the line flashes.";
+			frame.statusText += " Taps: " + std::to_string(calibration->getTapCount());
+		}
+	}
+	if (chart && !calibration) {
+		// Judgement runs on what the player hears, rendering is shifted so that following the visuals lines up with
+		// that too.
+		// The simulation runs up to one step ahead, so the frame is drawn between the two states without lagging.
+		const double time = musicStream->getTime() - calibrationOffsets.audio;
+		simulate(time);
+		const double factor = (time - previousState.time) / (currentState.time - previousState.time);
+		frame.view.distance = previousState.distance + (currentState.distance - previousState.distance) * factor;
+		frame.view.firstNote = previousState.nextNote;
+		frame.judgement = &judgementThread->getSnapshot();
+		frame.view.hitNotes = &frame.judgement->hitNotes;
+		frame.statusText = "Hit: " + std::to_string(frame.judgement->hitCount)
+			+ " / " + std::to_string(frame.judgement->hitCount + frame.judgement->missCount);
+	}
 
-	glClear(GL_COLOR_BUFFER_BIT);
+	// Rasterizing glyphs can touch the atlas textures, so the text is laid out and prepared here. Then the scene and
+	// the text are recorded in parallel, and this thread does the rest of the GL work afterwards.
+	layoutText();
+	prepareText();
+	const WorkerPool::Job jobs[] = {
+		{[](void *const renderer) { static_cast<Renderer*>(renderer)->buildScene(); }, this},
+		{[](void *const renderer) { static_cast<Renderer*>(renderer)->recordText(); }, this}
+	};
+	workerPool.runAll(jobs, std::size(jobs));
 
-	const auto camera = glm::translate(
-		glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.f, 1.f, 0.f))
-			* glm::scale(glm::identity<glm::mat4>(), glm::vec3(1.f, 2.f, 1.f))
-			* glm::perspectiveFov<float>(glm::radians(70.f), width, height * 2.f, 0.01f, 1000.f),
-		glm::vec3(0.f, -4.f, -7.f)
-	);
-	for (int i = -2; i != 3; ++i) testLine->render(
-		glm::translate(camera, glm::vec3(i, 0.f, 7.f)),
-		0.005f, 1000.f, {1.f, 1.f, 1.f, 0.7f}
+	textureLoader->tick();
+	background->render(renderQueue, width, height);
+	textRenderer->syncToGpu();
+	// Uploading the textures and glyphs bound them.
+	renderQueue.getStateCache().forgetTextures();
+	sceneCommands.submit(renderQueue);
+	textCommands.submit(renderQueue);
+	renderQueue.submit();
+#ifdef YUBINOBUTAI_PROFILER
+	Profiler::endFrame();
+#endif
+	streamingBuffer->endFrame();
+	sceneCommands.reset();
+	textCommands.reset();
+#ifdef YUBINOBUTAI_BENCHMARKS
+	if (renderQueue.getFrameCount() % 1000 == 0) {
+		const auto &stats = renderQueue.getStateCache().getStats();
+		aout << "Render queue: " << renderQueue.getDrawCount() << " draws over " << renderQueue.getFrameCount()
+			<< " frames, " << stats.issuedCalls << " state calls issued, " << stats.skippedCalls << " skipped"
+			<< std::endl;
+	}
+#endif
+}
+
+void Renderer::buildScene() {
+	static const int zone = Profiler::addZone("Scene building");
+	const Profiler::Scope scope(zone);
+	if (playfield) playfield->record(sceneCommands, *lineBatch, frame.view);
+#ifdef YUBINOBUTAI_PROFILER
+	recordProfilerGraph();
+#endif
+}
+
+#ifdef YUBINOBUTAI_PROFILER
+void Renderer::recordProfilerGraph() {
+	// A bar per recent frame along the bottom of the screen, newest on the right, and a line at the 60 Hz budget.
+	constexpr float left = 50.f, barSpacing = 3.f, pixelsPerMillisecond = 8.f, budget = 1000.f / 60.f;
+	constexpr float graphWidth = Profiler::historySize * barSpacing;
+	const int frameCount = Profiler::getFrameCount();
+	LineBatch::Line *const lines = sceneCommands.getArena().allocateArray<LineBatch::Line>(frameCount + 1);
+	for (int age = 0; age != frameCount; ++age) {
+		const float frameTime = Profiler::getFrame(age).frameTime;
+		lines[age] = {
+			glm::vec3(left + graphWidth - (age + .5f) * barSpacing, 0.f, 0.f), barSpacing - 1.f,
+			frameTime * pixelsPerMillisecond,
+			frameTime > budget ? Vector4{1.f, .3f, .3f, .8f} : Vector4{.3f, 1.f, .3f, .8f}
+		};
+	}
+	lines[frameCount] = {
+		glm::vec3(left + graphWidth / 2.f, 0.f, -budget * pixelsPerMillisecond), graphWidth, 1.f, {1.f, 1.f, 1.f, .8f}
+	};
+	// Lines lie on the XZ plane; this lays X across the screen and Z up from the bottom of the graph, in pixels.
+	const glm::mat4 graphMatrix(
+		glm::vec4(1.f, 0.f, 0.f, 0.f), glm::vec4(0.f, 0.f, 0.f, 0.f), glm::vec4(0.f, 1.f, 0.f, 0.f),
+		glm::vec4(0.f, height - 50.f, 0.f, 1.f)
 	);
-	for (int i = -3; i != 3; ++i) testLine->render(
-		glm::translate(camera, glm::vec3(i + 0.5f, 0.f, 0.f)),
-		0.005f, 0.5f, {1.f, 1.f, 1.f, 0.7f}
+	lineBatch->record(
+		sceneCommands, RenderQueue::Pass::Overlay,
+		glm::ortho<float>(0.f, static_cast<float>(width), static_cast<float>(height), 0.f) * graphMatrix,
+		lines, static_cast<std::size_t>(frameCount + 1)
 	);
-	testLine->render(camera, 6.f, 0.01f, {1.f, 1.f, 1.f, 1.f});
-	testLine->render(glm::translate(camera, glm::vec3(0.f, 0.f, -0.5f)), 6.f, 0.01f, {1.f, 1.f, 1.f, 1.f});
-	testLine->render(glm::translate(camera, glm::vec3(-3.f, 0.f, 7.f)), 0.01f, 1000.f, {1.f, 1.f, 1.f, 1.f});
-	testLine->render(glm::translate(camera, glm::vec3(3.f, 0.f, 7.f)), 0.01f, 1000.f, {1.f, 1.f, 1.f, 1.f});
-
-	time = musicStream->getTime();
-	const int minVisibleTime = static_cast<int>(time) - 200;
-	while (nextNote != notes.end() && nextNote->time < minVisibleTime) ++nextNote;
-	const int maxVisibleTime = static_cast<int>(time) + 10000;
-	for (
-		auto currentNote = nextNote;
-		currentNote != notes.end() && currentNote->time < maxVisibleTime;
-		++currentNote
-	) {
-		const auto &note = *currentNote;
-		if (!note.hit) testLine->render(
-			glm::translate(camera, glm::vec3(note.position / 2.f - 2.25f, 0.f, (time - note.time) / 1000. * 15.)),
-			1.5f, 0.5f, {1.f, 1.f, 0.f, 1.f}
-		);
-	}
+}
 
+void Renderer::dumpProfile() {
+	const std::string path = appData->activity->internalDataPath + "/profile.csv"s;
+	if (Profiler::dump(path)) aout << "Profile written to " << path << std::endl;
+}
+#endif
+
+void Renderer::layoutText() {
+	static const int zone = Profiler::addZone("Text layout");
+	const Profiler::Scope scope(zone);
 	TextLayout::Input textLayoutInput;
-	textLayoutInput.addRun(toTextRenderingString<char>(
-		"Hit: " + std::to_string(hitCount) + " / " + std::to_string(nextNote - notes.begin())
-	), 0, 48.f, 0.44f, 0.69f, 1.f, 1.f);
+	textLayoutInput.addRun(toTextRenderingString<char>(frame.statusText), 0, 48.f, 0.44f, 0.69f, 1.f, 1.f);
 	textLayoutInput.width = static_cast<float>(width - 100);
-	const TextLayout textLayout = TextLayout::make(fonts, textLayoutInput);
+	statusLayout = TextLayout::make(fonts, textLayoutInput);
+#ifdef YUBINOBUTAI_PROFILER
+	TextLayout::Input profileLayoutInput;
+	profileLayoutInput.addRun(toTextRenderingString<char>(Profiler::getSummary(6)), 0, 28.f, 1.f, 1.f, 1.f, .8f);
+	profileLayoutInput.width = static_cast<float>(width - 100);
+	profileLayout = TextLayout::make(fonts, profileLayoutInput);
+#endif
+}
+
+void Renderer::prepareText() {
 	textRenderer->tick();
-	textRenderer->prepareForRendering(textLayout, true);
-	textRenderer->syncToGpu();
-	textRenderer->renderText(textLayout, glm::translate<float>(
-		glm::ortho<float>(0.f, static_cast<float>(width), static_cast<float>(height), 0.f),
-		glm::vec3(50.f, 100.f, 0.f)
-	), true);
+	textRenderer->prepareForRendering(*statusLayout, true);
+#ifdef YUBINOBUTAI_PROFILER
+	textRenderer->prepareForRendering(*profileLayout, true);
+#endif
+}
+
+void Renderer::recordText() {
+	static const int zone = Profiler::addZone("Text recording");
+	const Profiler::Scope scope(zone);
+	const auto screenMatrix = glm::ortho<float>(0.f, static_cast<float>(width), static_cast<float>(height), 0.f);
+	textRenderer->renderText(
+		textCommands, *statusLayout, glm::translate<float>(screenMatrix, glm::vec3(50.f, 100.f, 0.f)), true
+	);
+#ifdef YUBINOBUTAI_PROFILER
+	textRenderer->renderText(
+		textCommands, *profileLayout, glm::translate<float>(screenMatrix, glm::vec3(50.f, 200.f, 0.f)), true
+	);
+#endif
+}
 
+void Renderer::simulate(const double time) {
+	static const int zone = Profiler::addZone("Simulation");
+	const Profiler::Scope scope(zone);
+	if (!isSimulationStarted || time - currentState.time > simulationStep * maxSimulationSteps) {
+		step(currentState, time);
+		previousState = currentState;
+		step(currentState, time + simulationStep);
+		isSimulationStarted = true;
+		return;
+	}
+	while (currentState.time < time) {
+		previousState = currentState;
+		step(currentState, currentState.time + simulationStep);
+	}
+}
+
+void Renderer::step(SimulationState &state, const double time) {
+	state.time = time;
+	state.distance = playfield->getTimingMap().getDistance(time + calibrationOffsets.visual, timingCursor);
+	playfield->advanceFirstNote(state.nextNote, time);
+}
+
+void Renderer::present() {
 	assert(eglSwapBuffers(display, surface) == EGL_TRUE);
 }
 
 oboe::DataCallbackResult Renderer::onAudioReady(
 	oboe::AudioStream *const currentAudioStream, void *const audioBuffer, const std::int32_t frames
 ) {
-	float *originalBuffer = static_cast<float*>(audioBuffer);
-	float *buffer = originalBuffer;
-	int actualFrames = aggregateStream->getAudio(buffer, frames);
-	for (int i = 0; i != actualFrames; ++i) {
-		const int firstSampleIndex = i * 2;
-		const float envelope = masterEnvelopeFollower(std::max(
-			std::abs(buffer[firstSampleIndex]), std::abs(buffer[firstSampleIndex + 1])
-		));
-		if (envelope > 1.f) {
-			buffer[firstSampleIndex] /= envelope;
-			buffer[firstSampleIndex + 1] /= envelope;
+	const RealtimeScope realtimeScope;
+	const std::int64_t now = AudioClock::now();
+	musicClock.update(musicStream->getTime(), now);
+	if (isCalibrating) metronomeClock.update(metronomeStream->getTime(), now);
+	const bool isInt16 = !mixBuffer.empty();
+	const int maxChunkFrames = isInt16 ? static_cast<int>(mixBuffer.size()) / 2 : frames;
+	for (int chunkStart = 0; chunkStart != frames;) {
+		const int chunkFrames = std::min(frames - chunkStart, maxChunkFrames);
+		float *const originalBuffer
+			= isInt16 ? mixBuffer.data() : static_cast<float*>(audioBuffer) + chunkStart * 2;
+		float *buffer = originalBuffer;
+		const int actualFrames = aggregateStream->getAudio(buffer, chunkFrames);
+		for (int i = 0; i != actualFrames; ++i) {
+			const int firstSampleIndex = i * 2;
+			const float envelope = masterEnvelopeFollower(std::max(
+				std::abs(buffer[firstSampleIndex]), std::abs(buffer[firstSampleIndex + 1])
+			));
+			if (envelope > 1.f) {
+				buffer[firstSampleIndex] /= envelope;
+				buffer[firstSampleIndex + 1] /= envelope;
+			}
+		}
+		if (isInt16) ditheringConverter.convert(
+			buffer, static_cast<std::int16_t*>(audioBuffer) + chunkStart * 2, actualFrames * 2
+		);
+		else if (buffer != originalBuffer) std::copy(buffer, buffer + actualFrames * 2, originalBuffer);
+		if (actualFrames != chunkFrames) {
+			// Whatever Oboe's buffer held would still be played.
+			const int firstSilentSample = (chunkStart + actualFrames) * 2;
+			if (isInt16) {
+				const auto output = static_cast<std::int16_t*>(audioBuffer);
+				std::fill(output + firstSilentSample, output + frames * 2, std::int16_t{0});
+			} else {
+				const auto output = static_cast<float*>(audioBuffer);
+				std::fill(output + firstSilentSample, output + frames * 2, 0.f);
+			}
+			return oboe::DataCallbackResult::Stop;
 		}
+		chunkStart += chunkFrames;
 	}
-	if (buffer != originalBuffer) std::copy(buffer, buffer + frames * 2, originalBuffer);
-	return actualFrames == frames ? oboe::DataCallbackResult::Continue : oboe::DataCallbackResult::Stop;
+	return oboe::DataCallbackResult::Continue;
 }
 
 Renderer::~Renderer() {
-	audioStream->close();
+	if (audioStream) audioStream->close();
+
+	// Their GL objects have to go while the context is still current.
+#ifdef YUBINOBUTAI_PROFILER
+	Profiler::shutdownGpu();
+#endif
+	background.reset();
+	textureLoader.reset();
+	textRenderer.reset();
+	lineBatch.reset();
+	streamingBuffer.reset();
 
 	if (display != EGL_NO_DISPLAY) {
 		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
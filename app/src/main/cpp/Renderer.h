@@ -1,6 +1,7 @@
 #ifndef YUBINOBUTAI_RENDERER_H
 #define YUBINOBUTAI_RENDERER_H
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -8,19 +9,34 @@
 #include <vector>
 
 #include <EGL/egl.h>
+#include <game-activity/GameActivityEvents.h>
 #include <minikin/MinikinPaint.h>
 #include <oboe/Oboe.h>
 #include <q/fx/envelope.hpp>
 #include <q/support/duration.hpp>
 
+#include <audio/AudioClock.h>
 #include <audio/AudioDecodingThread.h>
 #include <audio/AggregateAudioStream.h>
-#include <audio/PreloadedAudioStream.h>
-#include <audio/PreloadedAudioTrack.h>
+#include <audio/DitheringConverter.h>
+#include <audio/MetronomeAudioStream.h>
+#include <audio/SampleBank.h>
 #include <audio/StreamingAudioStream.h>
+#include <audio/TriggeredAudioStream.h>
+#include <text/TextLayout.h>
 #include <text/TextRenderer.h>
+#include "Background.h"
+#include "Calibration.h"
+#include "Chart.h"
+#include "CommandList.h"
+#include "JudgementThread.h"
+#include "LineBatch.h"
+#include "Playfield.h"
+#include "RenderQueue.h"
 #include "Shader.h"
-#include "TestLine.h"
+#include "StreamingBuffer.h"
+#include "TextureLoader.h"
+#include "WorkerPool.h"
 
 using namespace cycfi::q::literals;
 
@@ -37,35 +53,90 @@ class Renderer: public oboe::AudioStreamDataCallback {
 		EGLContext context;
 		EGLint width;
 		EGLint height;
+		// Copies of the size for the UI thread.
+		std::atomic<int> inputWidth = 0, inputHeight = 0;
 
 		std::vector<minikin::MinikinPaint> fonts;
-		std::optional<TestLine> testLine;
+		// Declared before everything drawing through it.
+		std::optional<StreamingBuffer> streamingBuffer;
+		RenderQueue renderQueue;
+		std::optional<LineBatch> lineBatch;
 		std::optional<TextRenderer> textRenderer;
+		std::optional<TextureLoader> textureLoader;
+		std::optional<Background> background;
+		// The calling thread takes a job too, so one worker is enough for the scene and the text.
+		WorkerPool workerPool{1};
+		CommandList sceneCommands, textCommands;
+		// What the frame's commands are built from, set before the workers start.
+		struct FrameState {
+			Playfield::View view;
+			// Null while calibrating.
+			const JudgementThread::Snapshot *judgement = nullptr;
+			std::string statusText;
+		};
+		FrameState frame;
+		// Laid out and prepared on this thread, since preparing the glyphs can create and delete atlas textures, then
+		// recorded on the worker pool.
+		std::optional<TextLayout> statusLayout;
+#ifdef YUBINOBUTAI_PROFILER
+		std::optional<TextLayout> profileLayout;
+#endif
 
 		AudioDecodingThread audioDecodingThread;
 		std::shared_ptr<oboe::AudioStream> audioStream;
 		std::unique_ptr<AggregateAudioStream> aggregateStream;
 		std::unique_ptr<StreamingAudioStream> musicStream;
-		std::unique_ptr<PreloadedAudioTrack> effectTrack;
+		std::optional<SampleBank> sampleBank;
+		SampleBank::Handle effectTrack;
+		std::unique_ptr<TriggeredAudioStream> effectStream;
+		std::unique_ptr<MetronomeAudioStream> metronomeStream;
+		AggregateAudioStream::Handle metronomeHandle;
+		// Published by the audio thread. The metronome's is only kept up to date during calibration.
+		AudioClock metronomeClock, musicClock;
 		cycfi::q::ar_envelope_follower masterEnvelopeFollower{5_ms, 100_ms, 48000.f};
+		// Used when the device outputs 16-bit samples natively: mixing is done here, then converted.
+		std::vector<float> mixBuffer;
+		DitheringConverter ditheringConverter;
 
-		struct PlayingEffect {
-			std::unique_ptr<PreloadedAudioStream> stream;
-			AggregateAudioStream::Handle handle;
-		};
-		std::vector<PlayingEffect> playingEffects;
+		std::optional<Chart> chart;
+		const Chart::Note *notes;
+		std::size_t noteCount;
+		std::optional<Playfield> playfield;
+		std::size_t timingCursor = 0;
+		std::unique_ptr<JudgementThread> judgementThread;
 
-		struct Note {
-			int time;
-			int position;
-			bool hit = false;
+		// Game state, advanced in fixed steps independent of the frame rate. Frames are drawn between the last two
+		// states.
+		struct SimulationState {
+			// Song time, as judged.
+			double time = 0.;
+			// Scroll distance at the time shifted by the visual offset.
+			double distance = 0.;
+			// Notes before this are out of sight for good.
+			std::size_t nextNote = 0;
 		};
-		std::vector<Note> notes;
-		std::vector<Note>::iterator nextNote;
-		int hitCount = 0;
-		double time = 0;
+		SimulationState previousState, currentState;
+		bool isSimulationStarted = false;
+
+		std::string calibrationPath;
+		std::optional<Calibration> calibration;
+		std::atomic_bool isCalibrating = false;
+		Calibration::Offsets calibrationOffsets;
 
-		void onTap(float pointerX, float pointerY);
+		void finishCalibration();
+		// Runs simulation steps until the current state is at or past the time.
+		void simulate(double time);
+		void step(SimulationState &state, double time);
+		// On this thread before the workers start, preparing the glyphs needs the GL context.
+		void layoutText();
+		void prepareText();
+		// Run on the worker pool, each only touching its own command list.
+		void buildScene();
+		void recordText();
+#ifdef YUBINOBUTAI_PROFILER
+		// Frame time graph for the overlay.
+		void recordProfilerGraph();
+#endif
 	public:
 		Renderer(android_app *const appData):
 			appData(appData),
@@ -75,8 +146,18 @@ class Renderer: public oboe::AudioStreamDataCallback {
 			initRenderer();
 		}
 		virtual ~Renderer();
+		// Called on the UI thread as soon as a motion event arrives, before it is queued for `handleInput`. Must only
+		// do thread safe work.
+		void handleEarlyInput(const GameActivityMotionEvent &motionEvent);
 		void handleInput();
+		// Draws the frame, `present` then shows it. Kept apart so the drawing can be timed without the wait for the
+		// display.
 		void render();
+		void present();
+#ifdef YUBINOBUTAI_PROFILER
+		// Writes the profiler's history to profile.csv in the app's data directory.
+		void dumpProfile();
+#endif
 
 		oboe::DataCallbackResult onAudioReady(
 			oboe::AudioStream *currentAudioStream, void *audioBuffer, std::int32_t frames
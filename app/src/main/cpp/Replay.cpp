@@ -0,0 +1,153 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Replay.h"
+
+namespace {
+	constexpr char magic[4] = {'Y', 'N', 'R', 'P'};
+	// Version 1 had no escape for larger pointer IDs and no judgements. Version 2 had no positions and escaped the
+	// pointer ID of events without one.
+	constexpr std::uint32_t currentVersion = 3;
+	constexpr std::size_t headerSize = 12;
+	constexpr int typeBits = 3;
+	constexpr int judgementsType = (1 << typeBits) - 1;
+	constexpr int escapedPointerId = 31;
+
+	void appendUint32(std::vector<unsigned char> &output, const std::uint32_t value) {
+		for (int i = 0; i != 4; ++i) output.push_back(static_cast<unsigned char>(value >> (i * 8)));
+	}
+
+	std::uint32_t readUint32(const unsigned char *const data) {
+		return data[0] | data[1] << 8 | data[2] << 16 | static_cast<std::uint32_t>(data[3]) << 24;
+	}
+
+	bool hasColumn(const ReplayEvent::Type type) {
+		return type == ReplayEvent::Type::Press || type == ReplayEvent::Type::Move;
+	}
+
+	bool hasPointer(const ReplayEvent::Type type) {
+		return hasColumn(type) || type == ReplayEvent::Type::Release;
+	}
+} // namespace
+
+ReplayWriter::ReplayWriter(const std::size_t noteCount): data(magic, magic + 4) {
+	appendUint32(data, currentVersion);
+	appendUint32(data, static_cast<std::uint32_t>(noteCount));
+}
+
+void ReplayWriter::appendVarint(std::uint64_t value) {
+	for (; value >= 0x80; value >>= 7) data.push_back(static_cast<unsigned char>(value | 0x80));
+	data.push_back(static_cast<unsigned char>(value));
+}
+
+void ReplayWriter::appendSignedVarint(const std::int64_t value) {
+	// Zigzag, so that small negative values stay short too.
+	appendVarint(static_cast<std::uint64_t>(value) << 1 ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void ReplayWriter::add(const ReplayEvent &event) {
+	const bool hasPointerId = hasPointer(event.type);
+	// Android hands out small IDs, but nothing guarantees it.
+	const bool isEscaped = hasPointerId && (event.pointerId < 0 || event.pointerId >= escapedPointerId);
+	data.push_back(static_cast<unsigned char>(
+		static_cast<int>(event.type) | (isEscaped ? escapedPointerId : hasPointerId ? event.pointerId : 0) << typeBits
+	));
+	if (isEscaped) appendVarint(static_cast<std::uint32_t>(event.pointerId));
+	// Batched samples can arrive slightly out of order, so the difference may be negative.
+	appendSignedVarint(event.time - lastTime);
+	lastTime = event.time;
+	if (hasColumn(event.type)) appendVarint(static_cast<std::uint64_t>(event.column + 1));
+	if (hasPointerId) {
+		appendSignedVarint(event.x);
+		appendSignedVarint(event.y);
+	}
+}
+
+void ReplayWriter::addJudgements(const std::vector<bool> &hitNotes) {
+	data.push_back(judgementsType);
+	const std::size_t start = data.size();
+	data.resize(start + (hitNotes.size() + 7) / 8);
+	for (std::size_t i = 0; i != hitNotes.size(); ++i) {
+		if (hitNotes[i]) data[start + i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+	}
+}
+
+bool ReplayWriter::save(const std::string &path) const {
+	std::ofstream stream(path, std::ios::binary);
+	stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	return static_cast<bool>(stream);
+}
+
+ReplayReader::ReplayReader(const unsigned char *const data, const std::size_t size):
+	current(data), end(data + size),
+	isValid(size >= headerSize && std::memcmp(data, magic, 4) == 0)
+{
+	if (!isValid) return;
+	version = readUint32(data + 4);
+	isValid = version >= 1 && version <= currentVersion;
+	if (!isValid) return;
+	noteCount = readUint32(data + 8);
+	current += headerSize;
+}
+
+bool ReplayReader::readVarint(std::uint64_t &value) {
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (current == end) return false;
+		const unsigned char byte = *current++;
+		value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+		if (byte < 0x80) return true;
+	}
+	return false;
+}
+
+bool ReplayReader::readSignedVarint(std::int64_t &value) {
+	std::uint64_t zigzag;
+	if (!readVarint(zigzag)) return false;
+	value = static_cast<std::int64_t>(zigzag >> 1 ^ (~(zigzag & 1) + 1));
+	return true;
+}
+
+bool ReplayReader::next(ReplayEvent &event) {
+	if (!isValid || current == end) return false;
+	const unsigned char header = *current++;
+	const int type = header & ((1 << typeBits) - 1);
+	if (type == judgementsType && version != 1) {
+		const std::size_t byteCount = (noteCount + 7) / 8;
+		if (static_cast<std::size_t>(end - current) < byteCount) return false;
+		hitNotes.resize(noteCount);
+		for (std::size_t i = 0; i != noteCount; ++i) hitNotes[i] = (current[i / 8] >> (i % 8) & 1) != 0;
+		hasJudgementData = true;
+		current = end;
+		return false;
+	}
+	if (type > static_cast<int>(ReplayEvent::Type::Advance)) return false;
+	event.type = static_cast<ReplayEvent::Type>(type);
+	event.pointerId = header >> typeBits;
+	std::uint64_t value;
+	if (event.pointerId == escapedPointerId && (version == 2 || (version > 2 && hasPointer(event.type)))) {
+		if (!readVarint(value)) return false;
+		event.pointerId = static_cast<int>(static_cast<std::uint32_t>(value));
+	}
+	if (version > 2 && !hasPointer(event.type)) event.pointerId = -1;
+	std::int64_t delta;
+	if (!readSignedVarint(delta)) return false;
+	lastTime += delta;
+	event.time = lastTime;
+	event.column = -1;
+	if (hasColumn(event.type)) {
+		if (!readVarint(value)) return false;
+		event.column = static_cast<int>(value) - 1;
+	}
+	event.x = event.y = 0;
+	if (version > 2 && hasPointer(event.type)) {
+		std::int64_t x, y;
+		if (!readSignedVarint(x) || !readSignedVarint(y)) return false;
+		event.x = static_cast<int>(x);
+		event.y = static_cast<int>(y);
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef YUBINOBUTAI_REPLAY_H
+#define YUBINOBUTAI_REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+	Everything that goes into judgement, recorded so that a play can be run again exactly. Times are on the song
+	clock in microseconds.
+
+	Format: the magic "YNRP", the format version and the chart's note count, each 4 bytes little endian, then the
+	events. Each event is a byte with the type in the low 3 bits and the pointer ID in the high 5 bits, the time
+	difference from the previous event as a zigzag varint, for presses and moves the column plus one as a varint, and
+	for presses, moves and releases the pointer position as two zigzag varints. Pointer IDs of 31 and up are stored as
+	31, followed by the actual ID as a varint. Events without a pointer store 0 in its place. A press or a move
+	typically takes 8 bytes. Optionally, the events are followed by a byte with the type bits all set, then a bit per
+	note, lowest bit first, set for the notes that were hit when the play was recorded.
+*/
+struct ReplayEvent {
+	enum class Type {Press, Move, Release, ReleaseAll, Advance};
+
+	Type type;
+	int pointerId; // -1 for releasing all pointers and advancing.
+	int column; // -1 if outside of the lanes.
+	std::int64_t time;
+	// Where the pointer was on the screen, in whole pixels. Only kept for presses, moves and releases. Judgement goes
+	// by the column.
+	int x = 0, y = 0;
+};
+
+class ReplayWriter final {
+	private:
+		std::vector<unsigned char> data;
+		std::int64_t lastTime = 0;
+
+		void appendVarint(std::uint64_t value);
+		void appendSignedVarint(std::int64_t value);
+	public:
+		explicit ReplayWriter(std::size_t noteCount);
+		void add(const ReplayEvent &event);
+		// Ends the events with the outcome, to check replaying against. Nothing can be added after.
+		void addJudgements(const std::vector<bool> &hitNotes);
+		const std::vector<unsigned char>& getData() const {
+			return data;
+		}
+		bool save(const std::string &path) const;
+};
+
+class ReplayReader final {
+	private:
+		const unsigned char *current, *end;
+		std::int64_t lastTime = 0;
+		std::size_t noteCount = 0;
+		std::uint32_t version = 0;
+		bool isValid;
+		std::vector<bool> hitNotes;
+		bool hasJudgementData = false;
+
+		bool readVarint(std::uint64_t &value);
+		bool readSignedVarint(std::int64_t &value);
+	public:
+		ReplayReader(const unsigned char *data, std::size_t size);
+		// Whether the header is intact.
+		bool isGood() const {
+			return isValid;
+		}
+		std::size_t getNoteCount() const {
+			return noteCount;
+		}
+		// Returns `false` at the end of the events or if the rest is corrupted.
+		bool next(ReplayEvent &event);
+		// Whether the recorded judgements were found, only known once `next` has returned `false`.
+		bool hasJudgements() const {
+			return hasJudgementData;
+		}
+		const std::vector<bool>& getHitNotes() const {
+			return hitNotes;
+		}
+};
+
+#endif // YUBINOBUTAI_REPLAY_H
\ No newline at end of file
@@ -1,29 +1,140 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "AndroidOut.h"
-#include "Model.h"
 #include "Utility.h"
 
 #include "Shader.h"
 
-std::unique_ptr<Shader> Shader::loadShader(const std::string &vertexSource, const std::string &fragmentSource) {
-	Shader *shader = nullptr;
+namespace {
+	std::string cacheDirectory;
+	std::vector<GLint> binaryFormats;
 
+	double getMilliseconds(const std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// FNV-1a, which is plenty for telling a handful of programs apart.
+	std::uint64_t hash(std::uint64_t value, const char *const data) {
+		// Include the terminator so that moving text from one string to the next changes the hash.
+		for (const char *character = data;; ++character) {
+			value = (value ^ static_cast<unsigned char>(*character)) * 0x100000001B3u;
+			if (*character == '\0') return value;
+		}
+	}
+
+	// A driver update can change or invalidate binaries, so the driver is part of the key.
+	std::string getCachePath(const std::string &vertexSource, const std::string &fragmentSource) {
+		std::uint64_t value = 0xCBF29CE484222325u;
+		value = hash(value, vertexSource.c_str());
+		value = hash(value, fragmentSource.c_str());
+		value = hash(value, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+		value = hash(value, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+		char name[32];
+		std::snprintf(name, sizeof(name), "/shader-%016llx.bin", static_cast<unsigned long long>(value));
+		return cacheDirectory + name;
+	}
+
+	// File layout: the binary format, then the binary.
+	GLuint loadCachedProgram(const std::string &path) {
+		std::ifstream stream(path, std::ios::binary);
+		GLenum format;
+		if (!stream.read(reinterpret_cast<char*>(&format), sizeof(format))) return 0;
+		// Left behind by a driver that no longer takes the format, which `glProgramBinary` would fail on.
+		if (std::find(binaryFormats.begin(), binaryFormats.end(), static_cast<GLint>(format)) == binaryFormats.end()) {
+			return 0;
+		}
+		const std::vector<char> binary{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+		if (binary.empty()) return 0;
+
+		GLuint program = glCreateProgram();
+		if (!program) return 0;
+		glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+		GLint linkStatus = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+		if (linkStatus != GL_TRUE) {
+			// Rejected, usually after a driver update kept the version string. It is compiled and saved again. The
+			// rejection may also raise an error, which the checks on the way there must not take for their own.
+			while (glGetError() != GL_NO_ERROR) {}
+			glDeleteProgram(program);
+			program = 0;
+		}
+		return program;
+	}
+
+	void saveCachedProgram(const GLuint program, const std::string &path) {
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+		std::vector<char> binary(length);
+		GLenum format;
+		glGetProgramBinary(program, length, &length, &format, binary.data());
+		// Written under another name first, so that a crash halfway doesn't leave a truncated binary to be loaded.
+		const std::string temporaryPath = path + ".tmp";
+		{
+			std::ofstream stream(temporaryPath, std::ios::binary);
+			stream.write(reinterpret_cast<const char*>(&format), sizeof(format));
+			stream.write(binary.data(), length);
+			if (!stream) return;
+		}
+		std::rename(temporaryPath.c_str(), path.c_str());
+	}
+} // namespace
+
+void Shader::setCacheDirectory(const std::string &directory) {
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	binaryFormats.resize(formatCount);
+	if (formatCount) glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, binaryFormats.data());
+	// Without any format, every binary would be rejected anyway.
+	cacheDirectory = formatCount ? directory : std::string();
+}
+
+std::unique_ptr<Shader> Shader::loadShader(
+	const char *const name, const std::string &vertexSource, const std::string &fragmentSource
+) {
+	std::string cachePath;
+	if (!cacheDirectory.empty()) {
+		const auto start = std::chrono::steady_clock::now();
+		cachePath = getCachePath(vertexSource, fragmentSource);
+		if (const GLuint program = loadCachedProgram(cachePath)) {
+			aout << "Shader " << name << ": loaded from the cache in " << getMilliseconds(start) << " ms" << std::endl;
+			return std::unique_ptr<Shader>(new Shader(program));
+		}
+	}
+
+	const GLuint program = linkProgram(name, vertexSource, fragmentSource);
+	if (!program) return nullptr;
+	if (!cachePath.empty()) saveCachedProgram(program, cachePath);
+	return std::unique_ptr<Shader>(new Shader(program));
+}
+
+GLuint Shader::linkProgram(const char *const name, const std::string &vertexSource, const std::string &fragmentSource) {
+	const auto compileStart = std::chrono::steady_clock::now();
 	GLuint vertexShader = loadShader(GL_VERTEX_SHADER, vertexSource);
-	if (!vertexShader) return nullptr;
+	if (!vertexShader) return 0;
 
 	GLuint fragmentShader = loadShader(GL_FRAGMENT_SHADER, fragmentSource);
 	if (!fragmentShader) {
 		glDeleteShader(vertexShader);
-		return nullptr;
+		return 0;
 	}
+	const double compileTime = getMilliseconds(compileStart);
 
+	const auto linkStart = std::chrono::steady_clock::now();
 	GLuint program = glCreateProgram();
 	if (program) {
 		glAttachShader(program, vertexShader);
 		glAttachShader(program, fragmentShader);
 
+		if (!cacheDirectory.empty()) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		glLinkProgram(program);
 		GLint linkStatus = GL_FALSE;
 		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
@@ -40,8 +151,10 @@ std::unique_ptr<Shader> Shader::loadShader(const std::string &vertexSource, cons
 			}
 
 			glDeleteProgram(program);
+			program = 0;
 		} else {
-			shader = new Shader(program);
+			aout << "Shader " << name << ": compiled in " << compileTime << " ms, linked in "
+				<< getMilliseconds(linkStart) << " ms" << std::endl;
 		}
 	}
 
@@ -49,7 +162,7 @@ std::unique_ptr<Shader> Shader::loadShader(const std::string &vertexSource, cons
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 
-	return std::unique_ptr<Shader>(shader);
+	return program;
 }
 
 GLuint Shader::loadShader(const GLenum shaderType, const std::string &shaderSource) {
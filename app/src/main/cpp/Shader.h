@@ -9,12 +9,19 @@
 class Shader {
 	private:
 		static GLuint loadShader(GLenum shaderType, const std::string &shaderSource);
+		static GLuint linkProgram(const char *name, const std::string &vertexSource, const std::string &fragmentSource);
 
 		GLuint program;
 
 		constexpr Shader(GLuint program): program(program) {}
 	public:
-		static std::unique_ptr<Shader> loadShader(const std::string &vertexSource, const std::string &fragmentSource);
+		// Linked programs are saved there and reused on later launches while the sources and the driver stay the same.
+		// Empty, the default, turns the cache off.
+		static void setCacheDirectory(const std::string &directory);
+		// The name is only used in the log.
+		static std::unique_ptr<Shader> loadShader(
+			const char *name, const std::string &vertexSource, const std::string &fragmentSource
+		);
 
 		~Shader() {
 			if (program != 0) {
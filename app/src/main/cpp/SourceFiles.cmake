@@ -1,18 +1,44 @@
 set(YUBINOBUTAI_SOURCE_FILES
 AndroidOut.cpp
+Background.cpp
+Benchmarks.cpp
 BitmapFont.cpp
+Calibration.cpp
+Chart.cpp
+FrameArena.cpp
+FramePacer.cpp
+GlStateCache.cpp
+JudgementIndex.cpp
+JudgementState.cpp
+JudgementThread.cpp
+LineBatch.cpp
+Playfield.cpp
+PointerTable.cpp
+Profiler.cpp
+RenderQueue.cpp
 Renderer.cpp
+Replay.cpp
 Shader.cpp
+StreamingBuffer.cpp
 TestLine.cpp
 TextureAsset.cpp
+TextureLoader.cpp
+TimingMap.cpp
 Utility.cpp
+WorkerPool.cpp
 main.cpp
 
 audio/AggregateAudioStream.cpp
 audio/AudioDecoder.cpp
+audio/DitheringConverter.cpp
+audio/MetronomeAudioStream.cpp
 audio/PreloadedAudioStream.cpp
 audio/PreloadedAudioTrack.cpp
+audio/RealtimeSafety.cpp
+audio/SampleBank.cpp
 audio/StreamingAudioStream.cpp
+audio/TriggeredAudioStream.cpp
+audio/WavDecoder.cpp
 
 text/MemoryFont.cpp
 text/SpriteSet.cpp
@@ -0,0 +1,123 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+// Needs the core declarations first.
+#include <GLES2/gl2ext.h>
+
+#include "AndroidOut.h"
+#include "Utility.h"
+
+#include "StreamingBuffer.h"
+
+namespace {
+	constexpr GLbitfield persistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT;
+
+	PFNGLBUFFERSTORAGEEXTPROC getBufferStorage() {
+		if (!Utility::hasGlExtension("GL_EXT_buffer_storage")) return nullptr;
+		return reinterpret_cast<PFNGLBUFFERSTORAGEEXTPROC>(eglGetProcAddress("glBufferStorageEXT"));
+	}
+} // namespace
+
+StreamingBuffer::StreamingBuffer(const std::size_t frameCapacity): frameCapacity(frameCapacity) {
+	create();
+	aout << "Streaming buffer: " << (isPersistent ? "persistently mapped" : "mapped per write") << std::endl;
+}
+
+StreamingBuffer::~StreamingBuffer() {
+	destroy();
+	deleteRetiredBuffers();
+}
+
+void StreamingBuffer::create() {
+	static const auto bufferStorage = getBufferStorage();
+	const auto size = static_cast<GLsizeiptr>(frameCapacity * frameCount);
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	if (bufferStorage) {
+		bufferStorage(GL_ARRAY_BUFFER, size, nullptr, persistentFlags);
+		mapping = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, persistentFlags));
+	}
+	isPersistent = mapping != nullptr;
+	if (!isPersistent) glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	currentFrame = 0;
+	usedSize = 0;
+}
+
+void StreamingBuffer::destroy() {
+	for (GLsync &fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = nullptr;
+	}
+	if (mapping) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		mapping = nullptr;
+	}
+	// Draws in a render queue may still point into it.
+	retiredBuffers.push_back(buffer);
+	buffer = 0;
+}
+
+void StreamingBuffer::deleteRetiredBuffers() {
+	if (retiredBuffers.empty()) return;
+	// Draws already issued keep the old storage alive until they're done.
+	glDeleteBuffers(static_cast<GLsizei>(retiredBuffers.size()), retiredBuffers.data());
+	retiredBuffers.clear();
+}
+
+std::size_t StreamingBuffer::getAlignedUsedSize() const {
+	return (usedSize + alignment - 1) / alignment * alignment;
+}
+
+void StreamingBuffer::reserve(const std::size_t size) {
+	if (getAlignedUsedSize() + size <= frameCapacity) return;
+	destroy();
+	while (frameCapacity < size) frameCapacity *= 2;
+	frameCapacity *= 2;
+	aout << "Streaming buffer grown to " << frameCapacity << " bytes per frame" << std::endl;
+	create();
+}
+
+std::optional<GLintptr> StreamingBuffer::write(const void *const data, const std::size_t size) {
+	reserve(size);
+	const std::size_t start = getAlignedUsedSize();
+	usedSize = start + size;
+	const auto offset = static_cast<GLintptr>(currentFrame * frameCapacity + start);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	if (isPersistent) {
+		std::memcpy(mapping + offset, data, size);
+	} else {
+		void *const destination = glMapBufferRange(
+			GL_ARRAY_BUFFER, offset, static_cast<GLsizeiptr>(size),
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+		);
+		if (destination == nullptr) {
+			aout << "Couldn't map the streaming buffer: GL error " << glGetError() << std::endl;
+			return std::nullopt;
+		}
+		std::memcpy(destination, data, size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	return offset;
+}
+
+void StreamingBuffer::endFrame() {
+	deleteRetiredBuffers();
+	GLsync &fence = fences[currentFrame];
+	if (fence) glDeleteSync(fence);
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	currentFrame = (currentFrame + 1) % frameCount;
+	usedSize = 0;
+	GLsync &nextFence = fences[currentFrame];
+	if (nextFence) {
+		// Rarely waits at all, the swap chain doesn't let the CPU run that far ahead.
+		glClientWaitSync(nextFence, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+		glDeleteSync(nextFence);
+		nextFence = nullptr;
+	}
+}
\ No newline at end of file
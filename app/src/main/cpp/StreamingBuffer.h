@@ -0,0 +1,56 @@
+#ifndef YUBINOBUTAI_STREAMINGBUFFER_H
+#define YUBINOBUTAI_STREAMINGBUFFER_H
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include <GLES3/gl3.h>
+
+// A buffer object that per-frame vertex data is written into, instead of handing client-side arrays to the draw calls
+// which makes the driver copy them synchronously. It's split into a region per frame in flight; each frame's region
+// is fenced when the frame ends and only written again once the GPU is done with it, so writes never have to
+// synchronize with draws. Where `EXT_buffer_storage` is available the buffer stays mapped for good, otherwise each
+// write maps its range unsynchronized.
+class StreamingBuffer final {
+	public:
+		static constexpr int frameCount = 3;
+		// Of every write.
+		static constexpr std::size_t alignment = 16;
+	private:
+		bool isPersistent = false;
+		GLuint buffer = 0;
+		std::size_t frameCapacity;
+		unsigned char *mapping = nullptr;
+		GLsync fences[frameCount] = {};
+		int currentFrame = 0;
+		// Within the current frame's region.
+		std::size_t usedSize = 0;
+		// Replaced during the frame, deleted when it ends.
+		std::vector<GLuint> retiredBuffers;
+
+		void create();
+		void destroy();
+		void deleteRetiredBuffers();
+		std::size_t getAlignedUsedSize() const;
+	public:
+		explicit StreamingBuffer(std::size_t frameCapacity = 1 << 20);
+		StreamingBuffer(const StreamingBuffer&) = delete;
+		StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+		~StreamingBuffer();
+		// Copies the data into the current frame's region and returns its offset in the buffer, which is left bound to
+		// `GL_ARRAY_BUFFER`. If the region is full, the buffer is first replaced with a bigger one, so get the buffer
+		// after writing. A replaced buffer stays alive until `endFrame` for the draws queued from it. Empty if the
+		// range couldn't be mapped, the draw should be skipped then.
+		std::optional<GLintptr> write(const void *data, std::size_t size);
+		// Makes sure writes adding up to `size` bytes, counting the padding between them, fit without replacing the
+		// buffer. For draws that need several writes.
+		void reserve(std::size_t size);
+		// After the last draw using this frame's data has been issued.
+		void endFrame();
+		GLuint getBuffer() const {
+			return buffer;
+		}
+};
+
+#endif // YUBINOBUTAI_STREAMINGBUFFER_H
\ No newline at end of file
@@ -35,14 +35,32 @@ void main() {
 }
 )fragment";
 
+const Index indices[] = {0, 1, 2, 2, 3, 0};
+
 } // namespace
 
-TestLine::TestLine(): shader(std::move(Shader::loadShader(vertexShader, fragmentShader))) {
+TestLine::TestLine(StreamingBuffer &streamingBuffer):
+	streamingBuffer(streamingBuffer),
+	shader(std::move(Shader::loadShader("TestLine", vertexShader, fragmentShader)))
+{
 	const auto shaderProgram = shader->getProgram();
 	uProjection = glGetUniformLocation(shaderProgram, "uProjection");
 	uHalfWidth = glGetUniformLocation(shaderProgram, "uHalfWidth");
 	uColor = glGetUniformLocation(shaderProgram, "uColor");
 	inPosition = glGetAttribLocation(shaderProgram, "inPosition");
+
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(inPosition);
+	glBindVertexArray(0);
+}
+
+TestLine::~TestLine() {
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteBuffers(1, &indexBuffer);
 }
 
 void TestLine::render(const glm::mat4 &matrix, const float width, const float height, const Vector4 color) const {
@@ -60,10 +78,13 @@ void TestLine::render(const glm::mat4 &matrix, const float width, const float he
 		halfWidth + 1.f, -height,
 		-halfWidth - 1.f, -height
 	};
-	static const Index indices[] = {0, 1, 2, 2, 3, 0};
+	const auto offset = streamingBuffer.write(vertices, sizeof(vertices));
+	if (!offset) return;
 
-	glEnableVertexAttribArray(inPosition);
-	glVertexAttribPointer(inPosition, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), vertices);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, indices);
-	glDisableVertexAttribArray(inPosition);
+	glBindVertexArray(vertexArray);
+	glVertexAttribPointer(
+		inPosition, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), reinterpret_cast<const void*>(*offset)
+	);
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+	glBindVertexArray(0);
 }
\ No newline at end of file
@@ -8,13 +8,19 @@
 
 #include "BasicData.h"
 #include "Shader.h"
+#include "StreamingBuffer.h"
 
 class TestLine {
 	private:
+		StreamingBuffer &streamingBuffer;
 		std::unique_ptr<Shader> shader;
 		GLuint uProjection, uHalfWidth, uColor, inPosition;
+		GLuint vertexArray = 0, indexBuffer = 0;
 	public:
-		TestLine();
+		explicit TestLine(StreamingBuffer &streamingBuffer);
+		TestLine(const TestLine&) = delete;
+		TestLine& operator=(const TestLine&) = delete;
+		~TestLine();
 		void render(const glm::mat4 &matrix, float width, float height, Vector4 color) const;
 };
 
@@ -1,18 +1,169 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+
 #include <android/asset_manager.h>
 #include <android/imagedecoder.h>
+#include <GLES3/gl3.h>
+// Needs the core declarations first.
+#include <GLES2/gl2ext.h>
 
 #include "AndroidOut.h"
 #include "TextureAsset.h"
 #include "Utility.h"
 
-std::shared_ptr<TextureAsset> TextureAsset::loadAsset(AAssetManager *const assetManager, const std::string &assetPath) {
+namespace {
+	// See the KTX 2.0 specification. Only the parts needed for a single 2D image with its mip levels are read.
+	const unsigned char ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+	constexpr std::size_t ktx2HeaderSize = 80;
+	constexpr std::size_t ktx2LevelSize = 24;
+
+	// Vulkan format numbers, which is how KTX2 stores formats.
+	constexpr std::uint32_t firstEtc2Format = 147;
+	constexpr std::uint32_t firstAstcFormat = 157;
+	constexpr std::uint32_t lastAstcFormat = 184;
+	// In the order of both enumerations.
+	const int astcBlockSizes[][2] = {
+		{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10},
+		{12, 12}
+	};
+
+	template<typename T>
+	T read(const unsigned char *const data) {
+		T value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	// ETC2 is part of OpenGL ES 3.0, ASTC needs the extension. Leaves the format at 0 for anything else.
+	void setCompressedFormat(TextureAsset::Image &image, const std::uint32_t vkFormat) {
+		if (vkFormat >= firstEtc2Format && vkFormat < firstEtc2Format + 6) {
+			const GLenum formats[] = {
+				GL_COMPRESSED_RGB8_ETC2, GL_COMPRESSED_SRGB8_ETC2, GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+				GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2, GL_COMPRESSED_RGBA8_ETC2_EAC,
+				GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+			};
+			image.format = formats[vkFormat - firstEtc2Format];
+			image.blockWidth = image.blockHeight = 4;
+			// Only the EAC formats carry a separate alpha block.
+			image.blockSize = vkFormat - firstEtc2Format >= 4 ? 16 : 8;
+		} else if (vkFormat >= firstAstcFormat && vkFormat <= lastAstcFormat) {
+			// Vulkan alternates between linear and sRGB for each block size.
+			const std::uint32_t block = (vkFormat - firstAstcFormat) / 2;
+			image.format = ((vkFormat - firstAstcFormat) % 2 ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+				: GL_COMPRESSED_RGBA_ASTC_4x4_KHR) + block;
+			image.blockWidth = astcBlockSizes[block][0];
+			image.blockHeight = astcBlockSizes[block][1];
+			image.blockSize = 16;
+		}
+	}
+} // namespace
+
+int TextureAsset::Image::getStorageLevelCount() const {
+	if (format) return static_cast<int>(levels.size());
+	int count = 1;
+	for (int size = std::max(getWidth(), getHeight()); size > 1; size /= 2) ++count;
+	return count;
+}
+
+std::size_t TextureAsset::Image::getTextureSize() const {
+	if (format) return data.size();
+	std::size_t size = 0;
+	for (int level = 0; level != getStorageLevelCount(); ++level)
+		size += static_cast<std::size_t>(std::max(getWidth() >> level, 1)) * std::max(getHeight() >> level, 1) * 4;
+	return size;
+}
+
+std::size_t TextureAsset::Image::getRowSize(const int level) const {
+	return static_cast<std::size_t>((levels[level].width + blockWidth - 1) / blockWidth) * blockSize;
+}
+
+bool TextureAsset::supportsAstc() {
+	static const bool isSupported = Utility::hasGlExtension("GL_KHR_texture_compression_astc_ldr");
+	return isSupported;
+}
+
+std::optional<TextureAsset::Image> TextureAsset::decode(
+	AAssetManager *const assetManager, const std::string &assetPath, const bool useAstc
+) {
+	const std::string basePath = assetPath.substr(0, assetPath.rfind('.'));
+	if (useAstc) {
+		if (auto image = decodeCompressed(assetManager, basePath + ".astc.ktx2")) return image;
+	}
+	if (auto image = decodeCompressed(assetManager, basePath + ".etc2.ktx2")) return image;
+	return decodeImage(assetManager, assetPath);
+}
+
+std::optional<TextureAsset::Image> TextureAsset::decodeCompressed(
+	AAssetManager *const assetManager, const std::string &assetPath
+) {
+	const std::unique_ptr<AAsset, void(*)(AAsset*)> asset(
+		AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER), AAsset_close
+	);
+	if (asset == nullptr) return std::nullopt;
+	const auto *const data = static_cast<const unsigned char*>(AAsset_getBuffer(asset.get()));
+	const auto size = static_cast<std::uint64_t>(AAsset_getLength64(asset.get()));
+	if (size < ktx2HeaderSize || std::memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) != 0) {
+		aout << assetPath << " isn't a KTX2 file" << std::endl;
+		return std::nullopt;
+	}
+
+	const auto vkFormat = read<std::uint32_t>(data + 12);
+	const auto width = read<std::uint32_t>(data + 20);
+	const auto height = read<std::uint32_t>(data + 24);
+	const auto depth = read<std::uint32_t>(data + 28);
+	const auto layerCount = read<std::uint32_t>(data + 32);
+	const auto faceCount = read<std::uint32_t>(data + 36);
+	// 0 asks for the levels to be generated, which compressed formats can't do.
+	const auto levelCount = std::max(read<std::uint32_t>(data + 40), 1u);
+	const auto supercompressionScheme = read<std::uint32_t>(data + 44);
+	if (depth > 1 || layerCount > 1 || faceCount != 1 || supercompressionScheme != 0) {
+		aout << assetPath << " isn't a single uncompressed 2D texture" << std::endl;
+		return std::nullopt;
+	}
+	Image image;
+	setCompressedFormat(image, vkFormat);
+	if (!image.format) {
+		aout << assetPath << " has unsupported format " << vkFormat << std::endl;
+		return std::nullopt;
+	}
+	if (size < ktx2HeaderSize + levelCount * ktx2LevelSize) return std::nullopt;
+	for (std::uint32_t level = 0; level != levelCount; ++level) {
+		const unsigned char *const levelData = data + ktx2HeaderSize + level * ktx2LevelSize;
+		const auto offset = read<std::uint64_t>(levelData), length = read<std::uint64_t>(levelData + 8);
+		const int levelWidth = static_cast<int>(std::max(width >> level, 1u));
+		const int levelHeight = static_cast<int>(std::max(height >> level, 1u));
+		const std::size_t expectedLength = static_cast<std::size_t>(
+			(levelWidth + image.blockWidth - 1) / image.blockWidth
+		) * ((levelHeight + image.blockHeight - 1) / image.blockHeight) * image.blockSize;
+		if (offset > size || length > size - offset || length != expectedLength) {
+			aout << assetPath << " is truncated" << std::endl;
+			return std::nullopt;
+		}
+		image.levels.push_back({levelWidth, levelHeight, image.data.size(), static_cast<std::size_t>(length)});
+		image.data.insert(image.data.end(), data + offset, data + offset + length);
+	}
+	return image;
+}
+
+std::optional<TextureAsset::Image> TextureAsset::decodeImage(
+	AAssetManager *const assetManager, const std::string &assetPath
+) {
 	// Get the image from asset manager
-	auto asset = AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER);
+	const std::unique_ptr<AAsset, void(*)(AAsset*)> asset(
+		AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER), AAsset_close
+	);
+	if (asset == nullptr) return std::nullopt;
 
 	// Make a decoder to turn it into a texture
 	AImageDecoder *decoder = nullptr;
-	auto result = AImageDecoder_createFromAAsset(asset, &decoder);
-	assert(result == ANDROID_IMAGE_DECODER_SUCCESS);
+	if (AImageDecoder_createFromAAsset(asset.get(), &decoder) != ANDROID_IMAGE_DECODER_SUCCESS) {
+		aout << "Failed to read " << assetPath << std::endl;
+		return std::nullopt;
+	}
+	const std::unique_ptr<AImageDecoder, void(*)(AImageDecoder*)> decoderOwner(decoder, AImageDecoder_delete);
 
 	// make sure we get 8 bits per channel out. RGBA order.
 	AImageDecoder_setAndroidBitmapFormat(decoder, ANDROID_BITMAP_FORMAT_RGBA_8888);
@@ -21,17 +172,24 @@ std::shared_ptr<TextureAsset> TextureAsset::loadAsset(AAssetManager *const asset
 	const AImageDecoderHeaderInfo *const header = AImageDecoder_getHeaderInfo(decoder);
 
 	// important metrics for sending to GL
-	auto width = AImageDecoderHeaderInfo_getWidth(header);
-	auto height = AImageDecoderHeaderInfo_getHeight(header);
-	auto stride = AImageDecoder_getMinimumStride(decoder);
+	Image image;
+	const int width = AImageDecoderHeaderInfo_getWidth(header);
+	const int height = AImageDecoderHeaderInfo_getHeight(header);
+	// Rows are packed as GL expects them.
+	const auto stride = static_cast<std::size_t>(width) * 4;
+	image.levels.push_back({width, height, 0, stride * height});
+	image.data.resize(stride * height);
 
 	// Get the bitmap data of the image
-	auto upAndroidImageData = std::make_unique<std::vector<uint8_t>>(height * stride);
-	auto decodeResult = AImageDecoder_decodeImage(
-		decoder, upAndroidImageData->data(), stride, upAndroidImageData->size()
-	);
-	assert(decodeResult == ANDROID_IMAGE_DECODER_SUCCESS);
+	if (AImageDecoder_decodeImage(decoder, image.data.data(), stride, image.data.size())
+		!= ANDROID_IMAGE_DECODER_SUCCESS) {
+		aout << "Failed to decode " << assetPath << std::endl;
+		return std::nullopt;
+	}
+	return image;
+}
 
+GLuint TextureAsset::createStorage(const Image &image) {
 	// Get an opengl texture
 	GLuint textureId;
 	glGenTextures(1, &textureId);
@@ -41,31 +199,65 @@ std::shared_ptr<TextureAsset> TextureAsset::loadAsset(AAssetManager *const asset
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	const int levelCount = image.getStorageLevelCount();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// A stored chain may stop before 1x1.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
 
-	// Load the texture into VRAM
-	glTexImage2D(
-		GL_TEXTURE_2D, // target
-		0, // mip level
-		GL_RGBA, // internal format, often advisable to use BGR
-		width, // width of the texture
-		height, // height of the texture
-		0, // border (always 0)
-		GL_RGBA, // format
-		GL_UNSIGNED_BYTE, // type
-		upAndroidImageData->data() // Data to upload
+	glTexStorage2D(
+		GL_TEXTURE_2D, levelCount, image.format ? image.format : GL_RGBA8, image.getWidth(), image.getHeight()
 	);
+	return textureId;
+}
 
-	// generate mip levels. Not really needed for 2D, but good to do
-	glGenerateMipmap(GL_TEXTURE_2D);
+void TextureAsset::uploadRows(const Image &image, const int level, const int y, const int height, const void *data) {
+	const int width = image.levels[level].width;
+	if (!image.format) {
+		glTexSubImage2D(GL_TEXTURE_2D, level, 0, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		return;
+	}
+	const auto size = static_cast<GLsizei>(
+		image.getRowSize(level) * ((height + image.blockHeight - 1) / image.blockHeight)
+	);
+	glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, y, width, height, image.format, size, data);
+}
 
-	// cleanup helpers
-	AImageDecoder_delete(decoder);
-	AAsset_close(asset);
+std::shared_ptr<TextureAsset> TextureAsset::upload(const Image &image) {
+	Utility::assertGlError();
+	const GLuint textureId = createStorage(image);
+	for (int level = 0; level != static_cast<int>(image.levels.size()); ++level) {
+		const auto &levelInfo = image.levels[level];
+		uploadRows(image, level, 0, levelInfo.height, image.data.data() + levelInfo.offset);
+	}
+	if (!image.format) glGenerateMipmap(GL_TEXTURE_2D);
+	// The driver has the final say on the sizes and block data.
+	if (!Utility::checkAndLogGlError()) {
+		glDeleteTextures(1, &textureId);
+		return nullptr;
+	}
+	return std::shared_ptr<TextureAsset>(
+		new TextureAsset(textureId, image.getWidth(), image.getHeight(), image.getTextureSize())
+	);
+}
 
-	// Create a shared pointer so it can be cleaned up easily/automatically
-	return std::shared_ptr<TextureAsset>(new TextureAsset(textureId));
+std::shared_ptr<TextureAsset> TextureAsset::loadAsset(AAssetManager *const assetManager, const std::string &assetPath) {
+	// Null for a version that is missing, unreadable or rejected by the driver.
+	const auto tryUpload = [](const std::optional<Image> &image, const std::string &path) {
+		std::shared_ptr<TextureAsset> texture;
+		if (!image) return texture;
+		texture = upload(*image);
+		if (texture == nullptr) aout << "Failed to upload " << path << std::endl;
+		return texture;
+	};
+	const std::string basePath = assetPath.substr(0, assetPath.rfind('.'));
+	if (supportsAstc()) {
+		const std::string path = basePath + ".astc.ktx2";
+		if (auto texture = tryUpload(decodeCompressed(assetManager, path), path)) return texture;
+	}
+	const std::string path = basePath + ".etc2.ktx2";
+	if (auto texture = tryUpload(decodeCompressed(assetManager, path), path)) return texture;
+	return tryUpload(decodeImage(assetManager, assetPath), assetPath);
 }
 
 TextureAsset::~TextureAsset() {
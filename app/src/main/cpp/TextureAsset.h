@@ -1,7 +1,9 @@
 #ifndef YUBINOBUTAI_TEXTUREASSET_H
 #define YUBINOBUTAI_TEXTUREASSET_H
 
+#include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -9,17 +11,79 @@
 #include <GLES3/gl3.h>
 
 class TextureAsset {
+	public:
+		// A decoded image, ready to be uploaded.
+		struct Image {
+			struct Level {
+				int width, height;
+				// Into `data`.
+				std::size_t offset, size;
+			};
+			// 0 for RGBA8888 pixels, whose mip levels are generated once uploaded.
+			GLenum format = 0;
+			// Compressed formats are made of blocks of pixels, RGBA8888 counts as 1x1 blocks.
+			int blockWidth = 1, blockHeight = 1, blockSize = 4;
+			std::vector<Level> levels;
+			std::vector<unsigned char> data;
+
+			int getWidth() const {
+				return levels.front().width;
+			}
+			int getHeight() const {
+				return levels.front().height;
+			}
+			// How many levels the texture needs, counting generated ones.
+			int getStorageLevelCount() const;
+			// What the texture takes in video memory, counting generated levels.
+			std::size_t getTextureSize() const;
+			// Bytes per row of blocks.
+			std::size_t getRowSize(int level) const;
+		};
 	private:
 		GLuint textureId;
+		int width, height;
+		// What the texture takes in video memory, mip levels included.
+		std::size_t byteSize;
 
-		TextureAsset(GLuint textureId): textureId(textureId) {}
+		TextureAsset(GLuint textureId, int width, int height, std::size_t byteSize):
+			textureId(textureId), width(width), height(height), byteSize(byteSize)
+		{}
 	public:
+		// Needs a current context the first time.
+		static bool supportsAstc();
+		// Doesn't touch GL, so this can run on any thread. Picks the version of the image the same way `loadAsset`
+		// does, but can't fall back once the driver rejects one.
+		static std::optional<Image> decode(AAssetManager *assetManager, const std::string &assetPath, bool useAstc);
+		// Reads a KTX2 file's mip chain as it is. Empty if the file is missing or isn't a plain ETC2 or ASTC texture.
+		static std::optional<Image> decodeCompressed(AAssetManager *assetManager, const std::string &assetPath);
+		// Decodes the image to RGBA8888.
+		static std::optional<Image> decodeImage(AAssetManager *assetManager, const std::string &assetPath);
+		// Makes an immutable texture with room for every level of the image, left bound to `GL_TEXTURE_2D`.
+		static GLuint createStorage(const Image &image);
+		// Uploads rows of a level to the bound texture; `y` and `height` are in pixels, whole blocks unless the rows
+		// reach the bottom. `data` points to the first of the rows, or is an offset while a pixel unpack buffer is
+		// bound.
+		static void uploadRows(const Image &image, int level, int y, int height, const void *data);
+		// Uploads the whole image, generating the mip levels of RGBA8888 ones. Null if the driver rejects it.
+		static std::shared_ptr<TextureAsset> upload(const Image &image);
+		// Prefers a pre-compressed version of the image when the GPU supports it: for "name.png", "name.astc.ktx2" if
+		// ASTC is available, then "name.etc2.ktx2". Falls back to the next one when a version is missing or the driver
+		// rejects it, and decodes the PNG last.
 		static std::shared_ptr<TextureAsset> loadAsset(AAssetManager *assetManager, const std::string &assetPath);
 
 		~TextureAsset();
 		constexpr GLuint getTextureId() const {
 			return textureId;
 		}
+		constexpr int getWidth() const {
+			return width;
+		}
+		constexpr int getHeight() const {
+			return height;
+		}
+		constexpr std::size_t getByteSize() const {
+			return byteSize;
+		}
 };
 
 #endif // YUBINOBUTAI_TEXTUREASSET_H
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <android/asset_manager.h>
+#include <GLES3/gl3.h>
+
+#include "AndroidOut.h"
+#include "Profiler.h"
+#include "StreamingBuffer.h"
+#include "TextureAsset.h"
+#include "Utility.h"
+
+#include "TextureLoader.h"
+
+TextureLoader::Texture::~Texture() {
+	if (textureId != 0) glDeleteTextures(1, &textureId);
+}
+
+TextureLoader::TextureLoader(
+	AAssetManager *const assetManager, StreamingBuffer &streamingBuffer, const std::size_t sliceSize
+):
+	assetManager(assetManager), streamingBuffer(streamingBuffer), sliceSize(sliceSize),
+	useAstc(TextureAsset::supportsAstc())
+{
+	// Transparent, so nothing shows until the texture is in.
+	const unsigned char placeholderPixel[4] = {};
+	glGenTextures(1, &placeholderId);
+	glBindTexture(GL_TEXTURE_2D, placeholderId);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixel);
+	thread = std::thread([this] { run(); });
+}
+
+TextureLoader::~TextureLoader() {
+	requests.enqueue({nullptr, {}});
+	thread.join();
+	for (const auto &upload : fencedUploads) glDeleteSync(upload.fence);
+	glDeleteTextures(1, &placeholderId);
+}
+
+void TextureLoader::run() {
+	Request request;
+	while (true) {
+		requests.wait_dequeue(request);
+		if (request.texture == nullptr) break;
+		// The texture is handed on rather than released here, so it is never deleted off the GL thread.
+		decodedImages.enqueue({
+			std::move(request.texture), TextureAsset::decode(assetManager, request.assetPath, useAstc)
+		});
+	}
+}
+
+TextureLoader::Handle TextureLoader::load(const std::string &assetPath) {
+	std::shared_ptr<Texture> texture(new Texture(placeholderId));
+	requests.enqueue({texture, assetPath});
+	++pendingCount;
+	return texture;
+}
+
+void TextureLoader::tick() {
+	static const int zone = Profiler::addZone("Texture streaming");
+	const Profiler::Scope scope(zone);
+	Upload decoded;
+	while (decodedImages.try_dequeue(decoded)) uploads.push_back(std::move(decoded));
+
+	std::size_t budget = sliceSize;
+	while (!uploads.empty() && budget) {
+		auto &upload = uploads.front();
+		// Failed, or nobody is waiting for it anymore.
+		if (!upload.image || upload.texture.use_count() == 1) {
+			if (!upload.image) aout << "Failed to load a texture" << std::endl;
+			--pendingCount;
+			uploads.pop_front();
+			continue;
+		}
+		const std::size_t uploadedSize = uploadSlice(upload, budget);
+		// The streaming buffer couldn't be mapped, the slice is tried again next frame.
+		if (uploadedSize == 0) break;
+		budget -= std::min(uploadedSize, budget);
+		const bool isUploaded = upload.level == static_cast<int>(upload.image->levels.size());
+		if (isUploaded && !upload.image->format) glGenerateMipmap(GL_TEXTURE_2D);
+		// A driver can reject a compressed format it lists, or run out of memory. The texture then stays on the
+		// placeholder rather than being marked resident with undefined contents.
+		if (!Utility::checkAndLogGlError()) {
+			aout << "Failed to upload a texture" << std::endl;
+			auto &texture = *upload.texture;
+			glDeleteTextures(1, &texture.textureId);
+			texture.textureId = 0;
+			texture.width = texture.height = 0;
+			--pendingCount;
+			uploads.pop_front();
+			continue;
+		}
+		if (isUploaded) {
+			upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			// The pixels are in the streaming buffer now.
+			upload.image.reset();
+			fencedUploads.push_back(std::move(upload));
+			uploads.pop_front();
+		}
+	}
+
+	// Fences pass in order.
+	while (!fencedUploads.empty()) {
+		auto &upload = fencedUploads.front();
+		if (glClientWaitSync(upload.fence, 0, 0) == GL_TIMEOUT_EXPIRED) break;
+		glDeleteSync(upload.fence);
+		upload.texture->isLoaded = true;
+		--pendingCount;
+		fencedUploads.pop_front();
+	}
+}
+
+std::size_t TextureLoader::uploadSlice(Upload &upload, const std::size_t budget) {
+	const auto &image = *upload.image;
+	auto &texture = *upload.texture;
+	if (texture.textureId == 0) {
+		texture.textureId = TextureAsset::createStorage(image);
+		texture.width = image.getWidth();
+		texture.height = image.getHeight();
+	} else {
+		glBindTexture(GL_TEXTURE_2D, texture.textureId);
+	}
+
+	std::size_t uploadedSize = 0;
+	while (upload.level != static_cast<int>(image.levels.size())) {
+		const auto &level = image.levels[upload.level];
+		const std::size_t rowSize = image.getRowSize(upload.level);
+		// At least one row of blocks per slice, so that an upload always moves forward.
+		const std::size_t fittingRows = (budget - uploadedSize) / rowSize;
+		if (uploadedSize && !fittingRows) break;
+		const int remainingRows = (level.height - upload.row + image.blockHeight - 1) / image.blockHeight;
+		const int rows = static_cast<int>(std::min<std::size_t>(std::max<std::size_t>(fittingRows, 1), remainingRows));
+		const std::size_t size = rowSize * rows;
+		const auto offset = streamingBuffer.write(
+			image.data.data() + level.offset + upload.row / image.blockHeight * rowSize, size
+		);
+		if (!offset) break;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamingBuffer.getBuffer());
+		TextureAsset::uploadRows(
+			image, upload.level, upload.row, std::min(rows * image.blockHeight, level.height - upload.row),
+			reinterpret_cast<const void*>(*offset)
+		);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		uploadedSize += size;
+		upload.row += rows * image.blockHeight;
+		if (upload.row >= level.height) {
+			++upload.level;
+			upload.row = 0;
+		}
+	}
+	return uploadedSize;
+}
\ No newline at end of file
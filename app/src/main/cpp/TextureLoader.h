@@ -0,0 +1,110 @@
+#ifndef YUBINOBUTAI_TEXTURELOADER_H
+#define YUBINOBUTAI_TEXTURELOADER_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <android/asset_manager.h>
+#include <ConcurrentQueue/blockingconcurrentqueue.h>
+#include <ConcurrentQueue/concurrentqueue.h>
+#include <GLES3/gl3.h>
+
+#include "StreamingBuffer.h"
+#include "TextureAsset.h"
+
+// Loads textures without stalling frames. Images are decoded on a thread of their own, then uploaded from the GL
+// thread a bounded slice per frame through the streaming buffer, which acts as a pixel unpack buffer. A fence after
+// the last slice tells when the GPU has the whole texture; until then, the texture shows a placeholder.
+class TextureLoader final {
+	public:
+		class Texture final {
+			friend class TextureLoader;
+			private:
+				GLuint placeholderId;
+				GLuint textureId = 0;
+				bool isLoaded = false;
+				int width = 0, height = 0;
+
+				explicit Texture(GLuint placeholderId): placeholderId(placeholderId) {}
+			public:
+				Texture(const Texture&) = delete;
+				Texture& operator=(const Texture&) = delete;
+				~Texture();
+				// The placeholder until the texture is resident.
+				GLuint getTextureId() const {
+					return isLoaded ? textureId : placeholderId;
+				}
+				bool isResident() const {
+					return isLoaded;
+				}
+				// 0 until resident.
+				int getWidth() const {
+					return width;
+				}
+				int getHeight() const {
+					return height;
+				}
+		};
+		// Must not outlive the loader, and is only to be used on the GL thread.
+		using Handle = std::shared_ptr<const Texture>;
+
+		// Upload bytes per frame.
+		static constexpr std::size_t defaultSliceSize = 256 << 10;
+	private:
+		struct Request {
+			// Null to stop the thread.
+			std::shared_ptr<Texture> texture;
+			std::string assetPath;
+		};
+		struct Upload {
+			std::shared_ptr<Texture> texture;
+			// Empty if decoding failed.
+			std::optional<TextureAsset::Image> image;
+			int level = 0;
+			// The next row to upload within the level.
+			int row = 0;
+			GLsync fence = nullptr;
+		};
+
+		AAssetManager *assetManager;
+		StreamingBuffer &streamingBuffer;
+		std::size_t sliceSize;
+		bool useAstc;
+		GLuint placeholderId = 0;
+		moodycamel::BlockingConcurrentQueue<Request> requests;
+		moodycamel::ConcurrentQueue<Upload> decodedImages;
+		// In order of arrival, the front one is being uploaded.
+		std::deque<Upload> uploads;
+		// Uploaded, waiting for their fences.
+		std::deque<Upload> fencedUploads;
+		// Loads not resident or failed yet.
+		std::size_t pendingCount = 0;
+		std::thread thread;
+
+		void run();
+		// Returns the bytes uploaded, 0 if the streaming buffer couldn't be mapped. The upload is done once its rows
+		// run out.
+		std::size_t uploadSlice(Upload &upload, std::size_t budget);
+	public:
+		TextureLoader(
+			AAssetManager *assetManager, StreamingBuffer &streamingBuffer, std::size_t sliceSize = defaultSliceSize
+		);
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader& operator=(const TextureLoader&) = delete;
+		~TextureLoader();
+		// Starts loading the image, the same way `TextureAsset::loadAsset` picks it.
+		Handle load(const std::string &assetPath);
+		// Once per frame on the GL thread, before the frame's draws. Uploads the next slice and publishes the textures
+		// whose fences have passed. Uploads the driver rejects are dropped and leave their textures on the
+		// placeholder. Binds textures and `GL_ARRAY_BUFFER`.
+		void tick();
+		std::size_t getPendingCount() const {
+			return pendingCount;
+		}
+};
+
+#endif // YUBINOBUTAI_TEXTURELOADER_H
\ No newline at end of file
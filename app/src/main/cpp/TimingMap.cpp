@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cstddef>
+
+#include "Chart.h"
+
+#include "TimingMap.h"
+
+TimingMap::TimingMap(const Chart::SpeedChange *const speedChanges, const std::size_t speedChangeCount) {
+	points.reserve(speedChangeCount + 1);
+	// Speed starts at 1 from time 0, or from the first speed change if that comes earlier.
+	const double startTime = speedChangeCount != 0 && speedChanges[0].time < 0 ? speedChanges[0].time : 0.;
+	points.push_back({startTime, 0., 1.});
+	for (std::size_t i = 0; i != speedChangeCount; ++i) {
+		const auto &speedChange = speedChanges[i];
+		const double speed = std::max(speedChange.speed, 0.f);
+		Point &last = points.back();
+		if (speedChange.time <= last.time) {
+			last.speed = speed;
+		} else {
+			points.push_back({
+				static_cast<double>(speedChange.time), getDistance(last, speedChange.time), speed
+			});
+		}
+	}
+}
+
+std::size_t TimingMap::findPoint(const double time) const {
+	const auto next = std::upper_bound(points.begin(), points.end(), time, [](const double time, const Point &point) {
+		return time < point.time;
+	});
+	return next == points.begin() ? 0 : next - points.begin() - 1;
+}
+
+double TimingMap::getDistance(const double time) const {
+	return getDistance(points[findPoint(time)], time);
+}
+
+double TimingMap::getDistance(const double time, std::size_t &cursor) const {
+	if (cursor >= points.size() || time < points[cursor].time) {
+		cursor = findPoint(time);
+	} else {
+		while (cursor + 1 != points.size() && points[cursor + 1].time <= time) ++cursor;
+	}
+	return getDistance(points[cursor], time);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef YUBINOBUTAI_TIMINGMAP_H
+#define YUBINOBUTAI_TIMINGMAP_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Chart.h"
+
+// Maps song time to scroll distance under a chart's speed changes. Distance is in milliseconds at the base speed, so
+// without speed changes it equals the time. The map is piecewise linear with one segment per speed change, built
+// from prefix sums at load; queries binary search the segments, or walk a cursor for times that only go forward.
+class TimingMap final {
+	private:
+		struct Point {
+			double time, distance, speed;
+		};
+		// Sorted by time, and by distance since speeds are never negative. Never empty.
+		std::vector<Point> points;
+
+		// The last point at or before the time, or the first point.
+		std::size_t findPoint(double time) const;
+		double getDistance(const Point &point, double time) const {
+			return point.distance + (time - point.time) * point.speed;
+		}
+	public:
+		TimingMap(const Chart::SpeedChange *speedChanges, std::size_t speedChangeCount);
+		double getDistance(double time) const;
+		// Same as `getDistance`, but first tries to move the cursor forward from where the last query left it. Cheap
+		// when the times passed with one cursor mostly increase. Start the cursor at 0.
+		double getDistance(double time, std::size_t &cursor) const;
+};
+
+#endif // YUBINOBUTAI_TIMINGMAP_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef YUBINOBUTAI_TRIPLEBUFFER_H
+#define YUBINOBUTAI_TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Hands values from one writer thread to one reader thread without locks. The writer fills its buffer and publishes
+// it, the reader always gets the latest published value and keeps it intact until it reads again. Neither side ever
+// waits for the other.
+template<typename T>
+class TripleBuffer final {
+	private:
+		static constexpr unsigned indexMask = 3, freshFlag = 4;
+
+		T buffers[3];
+		unsigned writeIndex = 0, readIndex = 1;
+		// The buffer in between, flagged if it's newer than what the reader has.
+		std::atomic<unsigned> middleIndex = 2;
+	public:
+		TripleBuffer() = default;
+		explicit TripleBuffer(const T &initialValue): buffers{initialValue, initialValue, initialValue} {}
+
+		// Writer only. The buffer holds whatever was published two times ago, so it has to be overwritten entirely.
+		T& getWriteBuffer() {
+			return buffers[writeIndex];
+		}
+		// Writer only.
+		void publish() {
+			writeIndex = middleIndex.exchange(writeIndex | freshFlag, std::memory_order_acq_rel) & indexMask;
+		}
+		// Reader only.
+		const T& read() {
+			if (middleIndex.load(std::memory_order_relaxed) & freshFlag)
+				readIndex = middleIndex.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+			return buffers[readIndex];
+		}
+};
+
+#endif // YUBINOBUTAI_TRIPLEBUFFER_H
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "Utility.h"
 #include "AndroidOut.h"
 
+#include <cstddef>
+#include <string_view>
+
 #include <GLES3/gl3.h>
 
 #define CHECK_ERROR(e) case e: aout << "GL Error: "#e << std::endl; break
@@ -24,6 +27,21 @@ bool Utility::checkAndLogGlError(bool alwaysLog) {
 	}
 }
 
+bool Utility::hasExtension(const char *const extensionList, const char *const name) {
+	const std::string_view extensions = extensionList ? extensionList : "";
+	for (std::size_t start = 0; start < extensions.size();) {
+		std::size_t end = extensions.find(' ', start);
+		if (end == std::string_view::npos) end = extensions.size();
+		if (extensions.substr(start, end - start) == name) return true;
+		start = end + 1;
+	}
+	return false;
+}
+
+bool Utility::hasGlExtension(const char *const name) {
+	return hasExtension(reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS)), name);
+}
+
 float* Utility::buildOrthographicMatrix(
 	float *const outMatrix, const float halfHeight, const float aspect, const float near, const float far
 ) {
@@ -9,6 +9,10 @@ class Utility {
 		static void assertGlError() {
 			assert(checkAndLogGlError());
 		}
+		// Whether a space separated list like GL_EXTENSIONS or EGL_EXTENSIONS has the extension. Null lists none.
+		static bool hasExtension(const char *extensions, const char *name);
+		// Whether GL_EXTENSIONS lists the extension. Needs a current context.
+		static bool hasGlExtension(const char *name);
 
 		/**
 		 * Generates an orthographic projection matrix given the half height, aspect ratio, near, and far
@@ -0,0 +1,52 @@
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(const int threadCount) {
+	threads.reserve(threadCount);
+	for (int i = 0; i != threadCount; ++i) threads.emplace_back([this] { run(); });
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		const std::lock_guard<std::mutex> lock(mutex);
+		isStopping = true;
+	}
+	workAvailable.notify_all();
+	for (std::thread &thread : threads) thread.join();
+}
+
+void WorkerPool::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		workAvailable.wait(lock, [this] { return isStopping || nextJob != jobCount; });
+		if (isStopping) return;
+		work(lock);
+	}
+}
+
+void WorkerPool::work(std::unique_lock<std::mutex> &lock) {
+	while (nextJob != jobCount) {
+		const Job job = jobs[nextJob++];
+		lock.unlock();
+		job.function(job.context);
+		lock.lock();
+		if (--unfinishedJobCount == 0) workDone.notify_all();
+	}
+}
+
+void WorkerPool::runAll(const Job *const newJobs, const std::size_t newJobCount) {
+	std::unique_lock<std::mutex> lock(mutex);
+	jobs = newJobs;
+	jobCount = newJobCount;
+	nextJob = 0;
+	unfinishedJobCount = newJobCount;
+	workAvailable.notify_all();
+	work(lock);
+	workDone.wait(lock, [this] { return unfinishedJobCount == 0; });
+	jobs = nullptr;
+	jobCount = nextJob = 0;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef YUBINOBUTAI_WORKERPOOL_H
+#define YUBINOBUTAI_WORKERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A few threads that run a batch of jobs in parallel with the caller, which waits for all of them. Jobs are plain
+// function pointers so handing them out allocates nothing.
+class WorkerPool final {
+	public:
+		struct Job {
+			void (*function)(void *context);
+			void *context;
+		};
+	private:
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable workAvailable, workDone;
+		const Job *jobs = nullptr;
+		std::size_t jobCount = 0, nextJob = 0, unfinishedJobCount = 0;
+		bool isStopping = false;
+
+		void run();
+		// Runs jobs until none are left to take. The lock is released while a job runs.
+		void work(std::unique_lock<std::mutex> &lock);
+	public:
+		explicit WorkerPool(int threadCount);
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+		~WorkerPool();
+		// Returns once every job is done. Jobs may run in any order and on any thread, this one included.
+		void runAll(const Job *jobs, std::size_t jobCount);
+};
+
+#endif // YUBINOBUTAI_WORKERPOOL_H
\ No newline at end of file
@@ -1,19 +1,53 @@
 #include <algorithm>
-#include <mutex>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 #include "AudioStream.h"
 
 #include "AggregateAudioStream.h"
 
-AggregateAudioStream::AggregateAudioStream(const int maxStreams): handles(maxStreams) {
+AggregateAudioStream::AggregateAudioStream(const int maxStreams):
+	handles(maxStreams), playingIndices(maxStreams, -1),
+	commands(maxStreams * 2), commandProducer(commands),
+	finishedIds(maxStreams * 2), finishedProducer(finishedIds)
+{
 	playingStreams.reserve(maxStreams);
+	retiredStreams.reserve(maxStreams);
 	const int lastIndex = maxStreams - 1;
 	for (int i = 0; i != lastIndex; ++i) handles[i].nextFreeId = i + 1;
 	handles[lastIndex].nextFreeId = -1;
 }
 
+void AggregateAudioStream::processCommands() {
+	Command batch[32];
+	while (true) {
+		const auto commandCount = commands.try_dequeue_bulk(batch, std::size(batch));
+		if (commandCount == 0) break;
+		for (std::size_t i = 0; i != commandCount; ++i) {
+			const Command &command = batch[i];
+			if (command.stream == nullptr) {
+				const int index = playingIndices[command.id];
+				if (index != -1) playingStreams[index].stream = nullptr;
+			} else {
+				playingIndices[command.id] = static_cast<int>(playingStreams.size());
+				playingStreams.push_back({command.id, command.stream});
+			}
+		}
+	}
+}
+
+void AggregateAudioStream::reserve(const int frameCount) {
+	streamBuffer.reserve(frameCount * 2);
+}
+
 int AggregateAudioStream::getAudio(float *&buffer, const int frameCount) {
-	const std::lock_guard<std::mutex> lock(mutex);
+	startedCallbacks.store(startedCallbacks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	// Pairs with the fence in `retire`.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	processCommands();
+
 	const int sampleCount = frameCount * 2;
 	std::fill(buffer, buffer + sampleCount, 0.f);
 	streamBuffer.resize(sampleCount);
@@ -30,49 +64,91 @@ int AggregateAudioStream::getAudio(float *&buffer, const int frameCount) {
 		}
 		if (finished) {
 			const int id = playingStream.id;
-			InternalHandle &handle = handles[id];
-			handle.playingIndex = -1;
-			handle.nextFreeId = nextFreeHandleId;
-			nextFreeHandleId = id;
+			playingIndices[id] = -1;
+			// The stream is not touched anymore from here on, so the controlling thread may destroy it as soon as it
+			// receives the ID.
+			finishedIds.try_enqueue(finishedProducer, id);
 			--newPlayingCount;
 			if (i != newPlayingCount) {
 				playingStream = playingStreams[newPlayingCount];
-				handles[playingStream.id].playingIndex = i;
+				playingIndices[playingStream.id] = i;
 			}
 		} else {
 			++i;
 		}
 	}
 	playingStreams.resize(newPlayingCount);
+
+	completedCallbacks.store(startedCallbacks.load(std::memory_order_relaxed), std::memory_order_release);
 	return frameCount;
 }
 
+void AggregateAudioStream::processFinishedStreams() {
+	int batch[32];
+	while (true) {
+		const auto idCount = finishedIds.try_dequeue_bulk(batch, std::size(batch));
+		if (idCount == 0) break;
+		for (std::size_t i = 0; i != idCount; ++i) {
+			const int id = batch[i];
+			InternalHandle &handle = handles[id];
+			handle.isPlaying = false;
+			handle.ownedStream.reset();
+			handle.nextFreeId = nextFreeHandleId;
+			nextFreeHandleId = id;
+		}
+	}
+}
+
 AggregateAudioStream::Handle AggregateAudioStream::play(AudioStream *const stream) {
-	const std::lock_guard<std::mutex> lock(mutex);
+	processFinishedStreams();
 	if (nextFreeHandleId == -1) return {-1, 0};
 	const int id = nextFreeHandleId;
 	InternalHandle &handle = handles[id];
-	handle.playingIndex = playingStreams.size();
+	handle.isPlaying = true;
 	handle.nonce = nextNonce;
 	++nextNonce;
-	playingStreams.push_back({id, stream});
 	nextFreeHandleId = handle.nextFreeId;
+	commands.enqueue(commandProducer, {id, stream});
 	return {id, handle.nonce};
 }
 
+AggregateAudioStream::Handle AggregateAudioStream::play(std::unique_ptr<AudioStream> stream) {
+	const Handle handle = play(stream.get());
+	if (handle.id != -1) handles[handle.id].ownedStream = std::move(stream);
+	return handle;
+}
+
 bool AggregateAudioStream::isPlaying(const Handle handle) {
 	if (handle.id == -1) return false;
+	processFinishedStreams();
 	const InternalHandle &internalHandle = handles[handle.id];
-	return internalHandle.nonce == handle.nonce && internalHandle.playingIndex != -1;
+	return internalHandle.nonce == handle.nonce && internalHandle.isPlaying;
 }
 
 void AggregateAudioStream::stop(const Handle handle) {
-	if (handle.id == -1) return;
-	const std::lock_guard<std::mutex> lock(mutex);
-	const InternalHandle &internalHandle = handles[handle.id];
-	if (internalHandle.nonce != handle.nonce) return;
-	const int index = internalHandle.playingIndex;
-	if (index != -1) playingStreams[index].stream = nullptr;
+	if (!isPlaying(handle)) return;
+	commands.enqueue(commandProducer, {handle.id, nullptr});
+	InternalHandle &internalHandle = handles[handle.id];
+	if (internalHandle.ownedStream) retire(std::move(internalHandle.ownedStream));
+}
+
+void AggregateAudioStream::retire(std::unique_ptr<AudioStream> stream) {
+	// Pairs with the fence in `getAudio`: either the audio thread's next callback is counted here, or it sees every
+	// command enqueued before this point.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	retiredStreams.push_back({std::move(stream), startedCallbacks.load(std::memory_order_relaxed)});
+	collectGarbage();
+}
+
+void AggregateAudioStream::collectGarbage() {
+	processFinishedStreams();
+	const unsigned long lastCompletedCallback = completedCallbacks.load(std::memory_order_acquire);
+	retiredStreams.erase(std::remove_if(
+		retiredStreams.begin(), retiredStreams.end(),
+		[lastCompletedCallback](const RetiredStream &retiredStream) {
+			return lastCompletedCallback > retiredStream.retiringCallback;
+		}
+	), retiredStreams.end());
 }
 
 AggregateAudioStream::~AggregateAudioStream() {}
\ No newline at end of file
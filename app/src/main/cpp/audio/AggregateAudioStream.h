@@ -1,30 +1,65 @@
 #ifndef YUBINOBUTAI_AGGREGATEAUDIOSTREAM_H
 #define YUBINOBUTAI_AGGREGATEAUDIOSTREAM_H
 
-#include <mutex>
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#include <ConcurrentQueue/concurrentqueue.h>
+
 #include "AudioStream.h"
 
+/*
+	Threading model:
+	- `getAudio` is called from the audio thread only and never locks. Everything else must be called from a single
+	controlling thread.
+	- Play and stop requests are sent to the audio thread through a queue, finished streams are reported back through
+	another one.
+	- Streams that may still be referenced by the audio thread are retired instead of destroyed. A retired stream is
+	tagged with the number of callbacks started so far and is only destroyed once a callback started after that has
+	completed, since that callback must have picked up every command sent before the stream was retired.
+*/
+
 class AggregateAudioStream final: public AudioStream {
 	private:
 		struct InternalHandle {
-			int playingIndex;
 			unsigned long nonce;
+			bool isPlaying;
 			int nextFreeId;
+			std::unique_ptr<AudioStream> ownedStream;
+		};
+		struct Command {
+			int id;
+			AudioStream *stream; // `nullptr` to stop the stream.
 		};
 		struct PlayingStream {
 			int id;
 			AudioStream *stream;
 		};
+		struct RetiredStream {
+			std::unique_ptr<AudioStream> stream;
+			unsigned long retiringCallback;
+		};
 
+		// Controlling thread data.
 		std::vector<InternalHandle> handles;
 		int nextFreeHandleId = 0;
 		unsigned long nextNonce = 0;
+		std::vector<RetiredStream> retiredStreams;
+
+		// Audio thread data.
 		std::vector<PlayingStream> playingStreams;
+		std::vector<int> playingIndices;
 		std::vector<float> streamBuffer;
 
-		std::mutex mutex;
+		moodycamel::ConcurrentQueue<Command> commands;
+		moodycamel::ProducerToken commandProducer;
+		moodycamel::ConcurrentQueue<int> finishedIds;
+		moodycamel::ProducerToken finishedProducer;
+		std::atomic<unsigned long> startedCallbacks = 0, completedCallbacks = 0;
+
+		void processCommands();
+		void processFinishedStreams();
 	public:
 		struct Handle {
 			int id;
@@ -32,11 +67,23 @@ class AggregateAudioStream final: public AudioStream {
 		};
 
 		AggregateAudioStream(int maxStreams = 100);
+		// The audio thread must have stopped calling `getAudio` by then.
 		~AggregateAudioStream();
+		// Preallocates for callbacks of up to the given size so that `getAudio` doesn't have to. Must be called before
+		// audio starts.
+		void reserve(int frameCount);
 		int getAudio(float *&buffer, int frameCount) override;
+		// The stream must outlive its playback, use `retire` to get rid of it while it may still be playing.
 		Handle play(AudioStream *stream);
+		// The stream is owned and destroyed when it finishes or gets stopped.
+		Handle play(std::unique_ptr<AudioStream> stream);
 		bool isPlaying(Handle handle);
 		void stop(Handle handle);
+		// Destroys the stream once the audio thread is guaranteed not to use it anymore. If it is playing, it must
+		// have been stopped.
+		void retire(std::unique_ptr<AudioStream> stream);
+		// Destroys retired streams that are no longer in use. Should be called regularly.
+		void collectGarbage();
 };
 
 #endif // YUBINOBUTAI_AGGREGATEAUDIOSTREAM_H
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef YUBINOBUTAI_AUDIOCLOCK_H
+#define YUBINOBUTAI_AUDIOCLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Relates the steady clock to the time of an audio stream. The audio thread publishes a reference point every
+// callback, other threads use it to place events such as touches on the stream's timeline.
+class AudioClock final {
+	private:
+		std::atomic<unsigned> sequence = 0;
+		std::atomic<double> referenceStreamTime = 0.;
+		std::atomic<std::int64_t> referenceSteadyTime = 0;
+	public:
+		// Nanoseconds, in the same base as input event times.
+		static std::int64_t now() {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()
+			).count();
+		}
+
+		// Audio thread only. The stream time is in milliseconds.
+		void update(const double streamTime, const std::int64_t steadyTime) {
+			const unsigned currentSequence = sequence.load(std::memory_order_relaxed);
+			sequence.store(currentSequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			referenceStreamTime.store(streamTime, std::memory_order_relaxed);
+			referenceSteadyTime.store(steadyTime, std::memory_order_relaxed);
+			sequence.store(currentSequence + 2, std::memory_order_release);
+		}
+
+		double toStreamTime(const std::int64_t steadyTime) const {
+			while (true) {
+				const unsigned startSequence = sequence.load(std::memory_order_acquire);
+				if (startSequence & 1) continue;
+				const double streamTime = referenceStreamTime.load(std::memory_order_relaxed);
+				const std::int64_t referenceTime = referenceSteadyTime.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) == startSequence)
+					return streamTime + (steadyTime - referenceTime) / 1e6;
+			}
+		}
+};
+
+#endif // YUBINOBUTAI_AUDIOCLOCK_H
\ No newline at end of file
@@ -39,6 +39,13 @@ class AudioDecodingThread final {
 		void addTask(Task task) {
 			tasks.enqueue(task);
 		}
+		// For adding tasks from the audio thread, a dedicated token lets the queue reuse its memory.
+		moodycamel::ProducerToken makeProducerToken() {
+			return moodycamel::ProducerToken(tasks);
+		}
+		void addTask(moodycamel::ProducerToken &producerToken, Task task) {
+			tasks.enqueue(producerToken, task);
+		}
 };
 
 #endif // YUBINOBUTAI_AUDIODECODINGTHREAD_H
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "DitheringConverter.h"
+
+namespace {
+	constexpr float int16Scale = 32767.f;
+
+	std::uint32_t nextRandom(std::uint32_t &state) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// Uniform in [0, 1), made by stuffing the top 23 random bits into the mantissa of a float in [1, 2).
+	float toUnitFloat(const std::uint32_t random) {
+		const std::uint32_t bits = (random >> 9) | 0x3F800000u;
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value - 1.f;
+	}
+
+	std::int16_t convertSample(const float sample, std::uint32_t &randomState) {
+		// The difference of two uniform variables gives a triangular distribution spanning ±1 LSB.
+		const float dither = toUnitFloat(nextRandom(randomState)) - toUnitFloat(nextRandom(randomState));
+		const float scaled = std::round(sample * int16Scale + dither);
+		return static_cast<std::int16_t>(std::clamp(scaled, -32768.f, 32767.f));
+	}
+
+#if defined(__aarch64__)
+	uint32x4_t nextRandom(uint32x4_t &state) {
+		state = veorq_u32(state, vshlq_n_u32(state, 13));
+		state = veorq_u32(state, vshrq_n_u32(state, 17));
+		state = veorq_u32(state, vshlq_n_u32(state, 5));
+		return state;
+	}
+
+	float32x4_t toUnitFloat(const uint32x4_t random) {
+		return vsubq_f32(
+			vreinterpretq_f32_u32(vorrq_u32(vshrq_n_u32(random, 9), vdupq_n_u32(0x3F800000u))), vdupq_n_f32(1.f)
+		);
+	}
+#endif
+} // namespace
+
+void DitheringConverter::convert(const float *source, std::int16_t *destination, const int sampleCount) {
+	int remainingCount = sampleCount;
+#if defined(__aarch64__)
+	uint32x4_t randomState = vld1q_u32(randomStates);
+	const float32x4_t scale = vdupq_n_f32(int16Scale);
+	for (; remainingCount >= 8; remainingCount -= 8, source += 8, destination += 8) {
+		const float32x4_t
+			dither1 = vsubq_f32(toUnitFloat(nextRandom(randomState)), toUnitFloat(nextRandom(randomState))),
+			dither2 = vsubq_f32(toUnitFloat(nextRandom(randomState)), toUnitFloat(nextRandom(randomState)));
+		// Round to nearest, then narrow with saturation.
+		const int32x4_t
+			samples1 = vcvtnq_s32_f32(vfmaq_f32(dither1, vld1q_f32(source), scale)),
+			samples2 = vcvtnq_s32_f32(vfmaq_f32(dither2, vld1q_f32(source + 4), scale));
+		vst1q_s16(destination, vcombine_s16(vqmovn_s32(samples1), vqmovn_s32(samples2)));
+	}
+	vst1q_u32(randomStates, randomState);
+#endif
+	for (int i = 0; remainingCount != 0; --remainingCount, ++source, ++destination, i = (i + 1) & 3)
+		*destination = convertSample(*source, randomStates[i]);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef YUBINOBUTAI_DITHERINGCONVERTER_H
+#define YUBINOBUTAI_DITHERINGCONVERTER_H
+
+#include <cstdint>
+
+// Converts float samples to 16-bit integers with triangular (TPDF) dither, for outputs that natively take 16-bit
+// samples. Real-time safe.
+class DitheringConverter final {
+	private:
+		// Four independent xorshift generators, one for each SIMD lane.
+		std::uint32_t randomStates[4] = {0x9E3779B9u, 0x85EBCA6Bu, 0xC2B2AE35u, 0x27D4EB2Fu};
+	public:
+		void convert(const float *source, std::int16_t *destination, int sampleCount);
+};
+
+#endif // YUBINOBUTAI_DITHERINGCONVERTER_H
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include <algorithm>
+
+#include "PreloadedAudioTrack.h"
+
+#include "MetronomeAudioStream.h"
+
+MetronomeAudioStream::MetronomeAudioStream(
+	const PreloadedAudioTrack &audioTrack, const double interval, const int clickCount
+): audioTrack(&audioTrack), intervalFrames(static_cast<int>(interval * 48.)), clickCount(clickCount) {}
+
+int MetronomeAudioStream::getAudio(float *&buffer, const int frameCount) {
+	std::fill(buffer, buffer + frameCount * 2, 0.f);
+	const float *const trackData = audioTrack->getAudioData().data();
+	const int trackLength = audioTrack->getLength();
+	const int endPosition = currentPosition + frameCount;
+	const int
+		firstClick = std::max(0, (currentPosition - trackLength) / intervalFrames),
+		pastLastClick = std::min(clickCount, (endPosition - 1) / intervalFrames + 1);
+	for (int click = firstClick; click < pastLastClick; ++click) {
+		const int clickStart = click * intervalFrames;
+		const int mixStart = std::max(currentPosition, clickStart);
+		const int mixEnd = std::min(endPosition, clickStart + trackLength);
+		for (int frame = mixStart; frame < mixEnd; ++frame) {
+			const int destinationIndex = (frame - currentPosition) * 2, sourceIndex = (frame - clickStart) * 2;
+			buffer[destinationIndex] += trackData[sourceIndex];
+			buffer[destinationIndex + 1] += trackData[sourceIndex + 1];
+		}
+	}
+	currentPosition = endPosition;
+	return frameCount;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef YUBINOBUTAI_METRONOMEAUDIOSTREAM_H
+#define YUBINOBUTAI_METRONOMEAUDIOSTREAM_H
+
+#include "AudioStream.h"
+
+class PreloadedAudioTrack;
+
+// Plays a preloaded track at a fixed interval for a number of times, then keeps going silently. Never finishes.
+class MetronomeAudioStream final: public AudioStream {
+	private:
+		const PreloadedAudioTrack *audioTrack;
+		int intervalFrames;
+		int clickCount;
+		int currentPosition = 0;
+	public:
+		// The interval is in milliseconds.
+		MetronomeAudioStream(const PreloadedAudioTrack &audioTrack, double interval, int clickCount);
+		int getAudio(float *&buffer, int frameCount) override;
+		double getTime() const {
+			return currentPosition / 48.;
+		}
+};
+
+#endif // YUBINOBUTAI_METRONOMEAUDIOSTREAM_H
\ No newline at end of file
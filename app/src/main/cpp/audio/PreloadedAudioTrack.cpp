@@ -1,12 +1,31 @@
+#include <memory>
 #include <string>
 
 #include <android/asset_manager.h>
 
 #include "AudioDecoder.h"
+#include "WavDecoder.h"
 
 #include "PreloadedAudioTrack.h"
 
-PreloadedAudioTrack::PreloadedAudioTrack(AAssetManager *const assetManager, const std::string &name) {
+PreloadedAudioTrack::PreloadedAudioTrack(
+	AAssetManager *const assetManager, const std::string &name, const bool alwaysUseDecoder
+) {
+	if (alwaysUseDecoder || !tryLoadWav(assetManager, name)) decode(assetManager, name);
+	length = static_cast<int>(audioData.size()) / 2;
+}
+
+bool PreloadedAudioTrack::tryLoadWav(AAssetManager *const assetManager, const std::string &name) {
+	const std::unique_ptr<AAsset, void(*)(AAsset*)> asset(
+		AAssetManager_open(assetManager, name.c_str(), AASSET_MODE_BUFFER), AAsset_close
+	);
+	if (asset == nullptr) return false;
+	const void *const data = AAsset_getBuffer(asset.get());
+	return data != nullptr
+		&& WavDecoder::decode(data, static_cast<std::size_t>(AAsset_getLength64(asset.get())), audioData);
+}
+
+void PreloadedAudioTrack::decode(AAssetManager *const assetManager, const std::string &name) {
 	AudioDecoder audioDecoder(assetManager, name);
 	while (true) {
 		const int chunkFrameCount = audioDecoder.decodeOneChunk();
@@ -15,5 +34,4 @@ PreloadedAudioTrack::PreloadedAudioTrack(AAssetManager *const assetManager, cons
 		audioData.resize(currentSampleCount + chunkFrameCount * 2);
 		audioDecoder.retrieveAudio(audioData.data() + currentSampleCount, chunkFrameCount);
 	}
-	length = static_cast<int>(audioData.size()) / 2;
 }
\ No newline at end of file
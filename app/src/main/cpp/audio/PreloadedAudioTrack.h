@@ -10,8 +10,13 @@ class PreloadedAudioTrack final {
 	private:
 		std::vector<float> audioData;
 		int length;
+
+		bool tryLoadWav(AAssetManager *assetManager, const std::string &name);
+		void decode(AAssetManager *assetManager, const std::string &name);
 	public:
-		PreloadedAudioTrack(AAssetManager *assetManager, const std::string &name);
+		// Uncompressed WAV files that need no conversion are read directly, anything else goes through FFmpeg.
+		// `alwaysUseDecoder` skips the direct path, for comparison.
+		PreloadedAudioTrack(AAssetManager *assetManager, const std::string &name, bool alwaysUseDecoder = false);
 		int getLength() const {
 			return length;
 		}
@@ -0,0 +1,188 @@
+#ifdef YUBINOBUTAI_REALTIME_SAFETY_CHECK
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+#include <dlfcn.h>
+#include <pthread.h>
+#include <unwind.h>
+
+#include "RealtimeSafety.h"
+
+namespace {
+#ifdef __ANDROID__
+	constexpr const char *logTag = "YubiNoButai";
+#endif
+	constexpr int maxReports = 32;
+	constexpr int maxBacktraceDepth = 24;
+
+	thread_local bool isInRealtimeScope = false;
+	// Set while reporting so that whatever the reporting itself does isn't reported again.
+	thread_local bool isReporting = false;
+	std::atomic<int> reportCount = 0;
+
+	void logError(const char *const format, ...) {
+		va_list arguments;
+		va_start(arguments, format);
+#ifdef __ANDROID__
+		__android_log_vprint(ANDROID_LOG_ERROR, logTag, format, arguments);
+#else
+		// For the host tests.
+		std::vfprintf(stderr, format, arguments);
+		std::fputc('\n', stderr);
+#endif
+		va_end(arguments);
+	}
+
+	struct BacktraceState {
+		void **current, **end;
+	};
+
+	_Unwind_Reason_Code collectFrame(_Unwind_Context *const context, void *const userPointer) {
+		auto &state = *static_cast<BacktraceState*>(userPointer);
+		const auto programCounter = _Unwind_GetIP(context);
+		if (programCounter == 0) return _URC_NO_REASON;
+		if (state.current == state.end) return _URC_END_OF_STACK;
+		*state.current = reinterpret_cast<void*>(programCounter);
+		++state.current;
+		return _URC_NO_REASON;
+	}
+
+	void reportViolation(const char *const operation) {
+		if (!isInRealtimeScope || isReporting) return;
+		isReporting = true;
+		const int reportIndex = reportCount.fetch_add(1, std::memory_order_relaxed);
+		if (reportIndex < maxReports) {
+			logError("Real-time safety violation #%d: %s", reportIndex + 1, operation);
+			void *frames[maxBacktraceDepth];
+			BacktraceState state{frames, frames + maxBacktraceDepth};
+			_Unwind_Backtrace(collectFrame, &state);
+			const int frameCount = static_cast<int>(state.current - frames);
+			// Skip the reporting machinery itself.
+			for (int i = 2; i < frameCount; ++i) {
+				Dl_info info;
+				if (dladdr(frames[i], &info) != 0 && info.dli_fname != nullptr) {
+					logError(
+						"  #%02d pc %p %s (%s+%#zx)", i - 2, frames[i],
+						info.dli_fname, info.dli_sname != nullptr ? info.dli_sname : "?",
+						static_cast<std::size_t>(
+							static_cast<const char*>(frames[i])
+							- static_cast<const char*>(info.dli_sname != nullptr ? info.dli_saddr : info.dli_fbase)
+						)
+					);
+				} else {
+					logError("  #%02d pc %p", i - 2, frames[i]);
+				}
+			}
+			if (reportIndex == maxReports - 1) logError("Further real-time safety violations are not reported.");
+		}
+		isReporting = false;
+	}
+} // namespace
+
+RealtimeScope::RealtimeScope(): wasInRealtimeScope(isInRealtimeScope) {
+	isInRealtimeScope = true;
+}
+
+RealtimeScope::~RealtimeScope() {
+	isInRealtimeScope = wasInRealtimeScope;
+}
+
+int RealtimeScope::getViolationCount() {
+	return reportCount.load(std::memory_order_relaxed);
+}
+
+// The `__real_` functions are provided by the linker's `--wrap` option, see `CMakeLists.txt`.
+extern "C" {
+
+void *__real_malloc(std::size_t size);
+void *__real_calloc(std::size_t count, std::size_t size);
+void *__real_realloc(void *pointer, std::size_t size);
+void __real_free(void *pointer);
+int __real_pthread_mutex_lock(pthread_mutex_t *mutex);
+#ifdef __ANDROID__
+void __real__ZNSt6__ndk15mutex4lockEv(std::mutex *mutex);
+#endif
+
+void *__wrap_malloc(const std::size_t size) {
+	reportViolation("malloc");
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(const std::size_t count, const std::size_t size) {
+	reportViolation("calloc");
+	return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *const pointer, const std::size_t size) {
+	reportViolation("realloc");
+	return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void *const pointer) {
+	if (pointer != nullptr) reportViolation("free");
+	__real_free(pointer);
+}
+
+int __wrap_pthread_mutex_lock(pthread_mutex_t *const mutex) {
+	reportViolation("pthread_mutex_lock");
+	return __real_pthread_mutex_lock(mutex);
+}
+
+#ifdef __ANDROID__
+// `std::mutex::lock`, which is implemented inside the shared C++ library. libstdc++ inlines it down to
+// `pthread_mutex_lock` instead.
+void __wrap__ZNSt6__ndk15mutex4lockEv(std::mutex *const mutex) {
+	reportViolation("std::mutex::lock");
+	__real__ZNSt6__ndk15mutex4lockEv(mutex);
+}
+#endif
+
+} // extern "C"
+
+// The default `new` and `delete` live in the shared C++ library and would bypass the wrappers above, so route them
+// through `malloc` and `free` from here.
+
+void* operator new(const std::size_t size) {
+	void *const pointer = std::malloc(size == 0 ? 1 : size);
+	if (pointer == nullptr) throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](const std::size_t size) {
+	return operator new(size);
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept {
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept {
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *const pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void *const pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void *const pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void *const pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+#endif // YUBINOBUTAI_REALTIME_SAFETY_CHECK
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef YUBINOBUTAI_REALTIMESAFETY_H
+#define YUBINOBUTAI_REALTIMESAFETY_H
+
+/*
+	Debugging aid for code that must not block, such as the audio callback. When built with
+	`YUBINOBUTAI_REALTIME_SAFETY_CHECK`, heap allocations and mutex locks made from this library while a
+	`RealtimeScope` is alive on the current thread are logged along with a backtrace. Otherwise this does nothing.
+
+	The checks work by wrapping the allocation and locking functions at link time, so calls made from inside other
+	shared libraries aren't seen.
+*/
+
+class RealtimeScope final {
+#ifdef YUBINOBUTAI_REALTIME_SAFETY_CHECK
+	private:
+		bool wasInRealtimeScope;
+	public:
+		RealtimeScope();
+		~RealtimeScope();
+		RealtimeScope(const RealtimeScope&) = delete;
+		RealtimeScope& operator=(const RealtimeScope&) = delete;
+		// Violations seen so far on any thread, including those past the reporting limit.
+		static int getViolationCount();
+#else
+	public:
+		RealtimeScope() {}
+#endif
+};
+
+#endif // YUBINOBUTAI_REALTIMESAFETY_H
\ No newline at end of file
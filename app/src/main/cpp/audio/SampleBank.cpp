@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <android/asset_manager.h>
+
+#include "PreloadedAudioTrack.h"
+
+#include "SampleBank.h"
+
+namespace {
+	// 64-bit FNV-1a, seeded with the size so that files differing only in length hash apart too.
+	std::uint64_t hashContents(const unsigned char *const data, const std::size_t size) {
+		std::uint64_t hash = 0xCBF29CE484222325 ^ size;
+		for (std::size_t i = 0; i != size; ++i) hash = (hash ^ data[i]) * 0x100000001B3;
+		return hash;
+	}
+} // namespace
+
+SampleBank::Handle::Handle(SampleBank &bank, Entry &entry): bank(&bank), entry(&entry) {
+	bank.acquire(entry);
+}
+
+SampleBank::Handle::Handle(const Handle &other): bank(other.bank), entry(other.entry) {
+	if (entry != nullptr) bank->acquire(*entry);
+}
+
+SampleBank::Handle::Handle(Handle &&other) noexcept:
+	bank(std::exchange(other.bank, nullptr)), entry(std::exchange(other.entry, nullptr))
+{}
+
+SampleBank::Handle& SampleBank::Handle::operator=(Handle other) noexcept {
+	std::swap(bank, other.bank);
+	std::swap(entry, other.entry);
+	return *this;
+}
+
+SampleBank::Handle::~Handle() {
+	if (entry != nullptr) bank->release(*entry);
+}
+
+SampleBank::SampleBank(AAssetManager *const assetManager, const std::size_t memoryBudget):
+	assetManager(assetManager), memoryBudget(memoryBudget)
+{}
+
+SampleBank::Handle SampleBank::load(const std::string &name) {
+	auto keyIterator = keysByName.find(name);
+	if (keyIterator == keysByName.end()) {
+		const std::unique_ptr<AAsset, void(*)(AAsset*)> asset(
+			AAssetManager_open(assetManager, name.c_str(), AASSET_MODE_BUFFER), AAsset_close
+		);
+		if (asset == nullptr) return {};
+		keyIterator = keysByName.emplace(name, hashContents(
+			static_cast<const unsigned char*>(AAsset_getBuffer(asset.get())),
+			static_cast<std::size_t>(AAsset_getLength64(asset.get()))
+		)).first;
+	}
+	const std::uint64_t key = keyIterator->second;
+	auto entryIterator = entries.find(key);
+	if (entryIterator == entries.end()) {
+		std::unique_ptr<PreloadedAudioTrack> track(new PreloadedAudioTrack(assetManager, name));
+		const std::size_t memorySize = track->getAudioData().size() * sizeof(float);
+		memoryUsage += memorySize;
+		// Start out unused, the handle below takes it out again.
+		entryIterator = entries.emplace(key, Entry{key, std::move(track), memorySize, 0, unusedEntries.add(key)}).first;
+	}
+	Handle handle(*this, entryIterator->second);
+	trim();
+	return handle;
+}
+
+void SampleBank::trim() {
+	while (memoryUsage > memoryBudget) {
+		const std::uint64_t *const key = unusedEntries.getLast();
+		if (key == nullptr) break;
+		const auto iterator = entries.find(*key);
+		unusedEntries.evictLast();
+		if (iterator == entries.end()) continue;
+		memoryUsage -= iterator->second.memorySize;
+		entries.erase(iterator);
+	}
+}
+
+void SampleBank::acquire(Entry &entry) {
+	if (entry.referenceCount++ == 0) unusedEntries.remove(entry.unusedHandle);
+}
+
+void SampleBank::release(Entry &entry) {
+	if (--entry.referenceCount != 0) return;
+	entry.unusedHandle = unusedEntries.add(entry.key);
+	trim();
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef YUBINOBUTAI_SAMPLEBANK_H
+#define YUBINOBUTAI_SAMPLEBANK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <android/asset_manager.h>
+
+#include <text/LruList.h>
+#include "PreloadedAudioTrack.h"
+
+/*
+	Shares decoded samples between everything that plays them. Samples are keyed by a hash of the asset's contents,
+	so the same sound is decoded and stored once no matter how many charts or names refer to it.
+
+	Samples nobody holds a handle to any more are kept around for reuse and evicted, least recently released first,
+	once the total memory goes over the budget. Samples in use are never evicted, even when over the budget.
+
+	Not thread safe: the bank and its handles must only be used from the thread that owns the bank.
+*/
+class SampleBank final {
+	private:
+		struct Entry {
+			std::uint64_t key;
+			std::unique_ptr<PreloadedAudioTrack> track;
+			std::size_t memorySize;
+			int referenceCount = 0;
+			LruList<std::uint64_t>::Handle unusedHandle;
+		};
+
+		AAssetManager *assetManager;
+		std::size_t memoryBudget;
+		std::size_t memoryUsage = 0;
+		std::unordered_map<std::uint64_t, Entry> entries;
+		std::unordered_map<std::string, std::uint64_t> keysByName;
+		LruList<std::uint64_t> unusedEntries;
+
+		void acquire(Entry &entry);
+		void release(Entry &entry);
+	public:
+		class Handle final {
+			private:
+				SampleBank *bank = nullptr;
+				Entry *entry = nullptr;
+			public:
+				Handle() = default;
+				Handle(SampleBank &bank, Entry &entry);
+				Handle(const Handle &other);
+				Handle(Handle &&other) noexcept;
+				Handle& operator=(Handle other) noexcept;
+				~Handle();
+				const PreloadedAudioTrack& operator*() const {
+					return *entry->track;
+				}
+				const PreloadedAudioTrack* operator->() const {
+					return entry->track.get();
+				}
+				explicit operator bool() const {
+					return entry != nullptr;
+				}
+		};
+
+		SampleBank(AAssetManager *assetManager, std::size_t memoryBudget = 64 << 20);
+		SampleBank(const SampleBank&) = delete;
+		SampleBank& operator=(const SampleBank&) = delete;
+		Handle load(const std::string &name);
+		// Evicts unused samples until the memory usage is within the budget or nothing more can be evicted.
+		void trim();
+		std::size_t getMemoryUsage() const {
+			return memoryUsage;
+		}
+};
+
+#endif // YUBINOBUTAI_SAMPLEBANK_H
\ No newline at end of file
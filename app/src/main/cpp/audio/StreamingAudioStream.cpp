@@ -14,7 +14,10 @@ namespace {
 
 StreamingAudioStream::Internal::Internal(
 	AAssetManager *const assetManager, const std::string &name, AudioDecodingThread &audioDecodingThread
-): audioDecodingThread(&audioDecodingThread), audioDecoder(assetManager, name) {
+):
+	audioDecodingThread(&audioDecodingThread), fillTaskProducer(audioDecodingThread.makeProducerToken()),
+	audioDecoder(assetManager, name)
+{
 	chunk1.buffer.reserve(loadBufferSize);
 	chunk2.buffer.reserve(loadBufferSize);
 	chunk1.hasNext = true;
@@ -64,7 +67,7 @@ int StreamingAudioStream::Internal::getAudio(float *&buffer, int frameCount) {
 			playingChunk2 = !playingChunk2;
 			currentChunkPosition = 0;
 			decodingNextChunk = true;
-			audioDecodingThread->addTask({this, false});
+			audioDecodingThread->addTask(fillTaskProducer, {this, false});
 		}
 	}
 }
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include <android/asset_manager.h>
+#include <ConcurrentQueue/concurrentqueue.h>
 
 #include "AudioDecoder.h"
 #include "AudioStream.h"
@@ -22,6 +23,7 @@ class StreamingAudioStream final: public AudioStream {
 				};
 
 				AudioDecodingThread *audioDecodingThread;
+				moodycamel::ProducerToken fillTaskProducer;
 				AudioDecoder audioDecoder;
 				Chunk chunk1, chunk2;
 				bool playingChunk2 = false;
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+
+#include "PreloadedAudioTrack.h"
+
+#include "TriggeredAudioStream.h"
+
+namespace {
+	constexpr std::int64_t maxTriggerAge = 200'000'000;
+	constexpr std::int64_t nanosecondsPerFrame = 1'000'000'000 / 48000;
+} // namespace
+
+TriggeredAudioStream::TriggeredAudioStream(const PreloadedAudioTrack &audioTrack, const int maxVoices):
+	audioTrack(&audioTrack), voices(maxVoices)
+{}
+
+void TriggeredAudioStream::trigger(const std::int64_t eventTime) {
+	triggerTimes.enqueue(eventTime);
+}
+
+int TriggeredAudioStream::getAudio(float *&buffer, const int frameCount) {
+	std::int64_t batch[32];
+	const auto triggerCount = triggerTimes.try_dequeue_bulk(batch, std::size(batch));
+	if (triggerCount != 0) {
+		const std::int64_t
+			now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()
+			).count(),
+			firstTime = *std::min_element(batch, batch + triggerCount);
+		for (std::size_t i = 0; i != triggerCount; ++i) {
+			if (now - batch[i] > maxTriggerAge) continue;
+			// The earliest trigger starts right away, the others keep their distance to it.
+			const int delay = static_cast<int>((batch[i] - firstTime) / nanosecondsPerFrame);
+			if (voiceCount == static_cast<int>(voices.size())) {
+				// Steal the oldest voice.
+				std::max_element(voices.begin(), voices.end(), [](const Voice &a, const Voice &b) {
+					return a.position < b.position;
+				})->position = -delay;
+			} else {
+				voices[voiceCount].position = -delay;
+				++voiceCount;
+			}
+		}
+	}
+
+	const int sampleCount = frameCount * 2;
+	std::fill(buffer, buffer + sampleCount, 0.f);
+	const float *const trackData = audioTrack->getAudioData().data();
+	const int trackLength = audioTrack->getLength();
+	for (int i = 0; i != voiceCount;) {
+		Voice &voice = voices[i];
+		const int startFrame = std::max(0, -voice.position);
+		const int trackStart = std::max(0, voice.position);
+		const int mixedFrameCount = std::max(0, std::min(frameCount - startFrame, trackLength - trackStart));
+		const float *const source = trackData + trackStart * 2;
+		float *const destination = buffer + startFrame * 2;
+		for (int sample = 0; sample != mixedFrameCount * 2; ++sample) destination[sample] += source[sample];
+		voice.position += frameCount;
+		if (voice.position >= trackLength) {
+			--voiceCount;
+			voice = voices[voiceCount];
+		} else {
+			++i;
+		}
+	}
+	return frameCount;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef YUBINOBUTAI_TRIGGEREDAUDIOSTREAM_H
+#define YUBINOBUTAI_TRIGGEREDAUDIOSTREAM_H
+
+#include <cstdint>
+#include <vector>
+
+#include <ConcurrentQueue/concurrentqueue.h>
+
+#include "AudioStream.h"
+
+class PreloadedAudioTrack;
+
+// Plays a preloaded track polyphonically every time it is triggered, never finishes. Triggers may come from any
+// thread and are picked up on the next audio callback, so they don't have to wait for the game loop.
+class TriggeredAudioStream final: public AudioStream {
+	private:
+		struct Voice {
+			int position; // Negative while waiting to start.
+		};
+
+		const PreloadedAudioTrack *audioTrack;
+		moodycamel::ConcurrentQueue<std::int64_t> triggerTimes;
+		std::vector<Voice> voices;
+		int voiceCount = 0;
+	public:
+		TriggeredAudioStream(const PreloadedAudioTrack &audioTrack, int maxVoices = 32);
+		// The time is in nanoseconds of the steady clock, used to keep the relative timing of triggers that land in
+		// the same callback and to drop stale ones.
+		void trigger(std::int64_t eventTime);
+		int getAudio(float *&buffer, int frameCount) override;
+};
+
+#endif // YUBINOBUTAI_TRIGGEREDAUDIOSTREAM_H
\ No newline at end of file
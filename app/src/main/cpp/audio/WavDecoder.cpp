@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "WavDecoder.h"
+
+namespace {
+	constexpr std::uint16_t formatPcm = 1, formatFloat = 3, formatExtensible = 0xFFFE;
+
+	std::uint32_t readUint(const unsigned char *const data, const int bytes) {
+		std::uint32_t value = 0;
+		for (int i = bytes - 1; i != -1; --i) value = (value << 8) | data[i];
+		return value;
+	}
+
+	bool hasTag(const unsigned char *const data, const char *const tag) {
+		return std::memcmp(data, tag, 4) == 0;
+	}
+
+	// The converters turn `count` samples into floats, keeping the channel layout.
+
+	void convertInt16(const unsigned char *source, float *destination, std::size_t count) {
+#if defined(__aarch64__)
+		const float32x4_t scale = vdupq_n_f32(1.f / 32768.f);
+		for (; count >= 8; count -= 8, source += 16, destination += 8) {
+			const int16x8_t samples = vreinterpretq_s16_u8(vld1q_u8(source));
+			vst1q_f32(destination, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), scale));
+			vst1q_f32(destination + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+		}
+#endif
+		for (; count != 0; --count, source += 2, ++destination)
+			*destination = static_cast<std::int16_t>(readUint(source, 2)) / 32768.f;
+	}
+
+	void convertInt24(const unsigned char *source, float *destination, std::size_t count) {
+		for (; count != 0; --count, source += 3, ++destination)
+			*destination = static_cast<std::int32_t>(readUint(source, 3) << 8) / 2147483648.f;
+	}
+
+	void convertInt32(const unsigned char *source, float *destination, std::size_t count) {
+#if defined(__aarch64__)
+		const float32x4_t scale = vdupq_n_f32(1.f / 2147483648.f);
+		for (; count >= 4; count -= 4, source += 16, destination += 4)
+			vst1q_f32(destination, vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u8(vld1q_u8(source))), scale));
+#endif
+		for (; count != 0; --count, source += 4, ++destination)
+			*destination = static_cast<std::int32_t>(readUint(source, 4)) / 2147483648.f;
+	}
+
+	void convertFloat(const unsigned char *const source, float *const destination, const std::size_t count) {
+		std::memcpy(destination, source, count * sizeof(float));
+	}
+} // namespace
+
+bool WavDecoder::decode(const void *const data, const std::size_t size, std::vector<float> &output) {
+	const auto *const bytes = static_cast<const unsigned char*>(data);
+	if (size < 12 || !hasTag(bytes, "RIFF") || !hasTag(bytes + 8, "WAVE")) return false;
+
+	int channelCount = 0, bitsPerSample = 0;
+	std::uint16_t format = 0;
+	const unsigned char *sampleData = nullptr;
+	std::size_t sampleDataSize = 0;
+	for (std::size_t position = 12; position + 8 <= size;) {
+		const unsigned char *const chunk = bytes + position;
+		const std::size_t chunkSize = readUint(chunk + 4, 4);
+		const std::size_t availableSize = std::min(chunkSize, size - position - 8);
+		if (hasTag(chunk, "fmt ")) {
+			if (availableSize < 16) return false;
+			format = static_cast<std::uint16_t>(readUint(chunk + 8, 2));
+			channelCount = static_cast<int>(readUint(chunk + 10, 2));
+			if (readUint(chunk + 12, 4) != 48000) return false;
+			bitsPerSample = static_cast<int>(readUint(chunk + 22, 2));
+			// The sub-format GUID starts with the actual format tag.
+			if (format == formatExtensible) {
+				if (availableSize < 26) return false;
+				format = static_cast<std::uint16_t>(readUint(chunk + 32, 2));
+			}
+		} else if (hasTag(chunk, "data")) {
+			sampleData = chunk + 8;
+			sampleDataSize = availableSize;
+			break;
+		}
+		// Chunks are padded to even sizes.
+		position += 8 + chunkSize + (chunkSize & 1);
+	}
+	if (sampleData == nullptr || (channelCount != 1 && channelCount != 2)) return false;
+
+	void (*convert)(const unsigned char*, float*, std::size_t);
+	if (format == formatPcm && bitsPerSample == 16) convert = convertInt16;
+	else if (format == formatPcm && bitsPerSample == 24) convert = convertInt24;
+	else if (format == formatPcm && bitsPerSample == 32) convert = convertInt32;
+	else if (format == formatFloat && bitsPerSample == 32) convert = convertFloat;
+	else return false;
+
+	const std::size_t frameCount = sampleDataSize / (bitsPerSample / 8 * channelCount);
+	const std::size_t outputStart = output.size();
+	output.resize(outputStart + frameCount * 2);
+	float *const destination = output.data() + outputStart;
+	if (channelCount == 2) {
+		convert(sampleData, destination, frameCount * 2);
+	} else {
+		// Convert into the second half, then spread forward. Each frame is read before anything overwrites it.
+		convert(sampleData, destination + frameCount, frameCount);
+		for (std::size_t i = 0; i != frameCount; ++i) {
+			const float sample = destination[frameCount + i];
+			destination[i * 2] = sample;
+			destination[i * 2 + 1] = sample;
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef YUBINOBUTAI_WAVDECODER_H
+#define YUBINOBUTAI_WAVDECODER_H
+
+#include <cstddef>
+#include <vector>
+
+// Decodes uncompressed RIFF/WAVE data directly, which is much cheaper than going through FFmpeg for short samples.
+// Only handles what needs no resampling: 48 kHz, mono or stereo, 16/24/32-bit integer or 32-bit float PCM.
+class WavDecoder final {
+	public:
+		// Appends interleaved stereo samples to the output. Returns `false`, leaving the output untouched, if the data
+		// isn't in a supported format.
+		static bool decode(const void *data, std::size_t size, std::vector<float> &output);
+};
+
+#endif // YUBINOBUTAI_WAVDECODER_H
\ No newline at end of file
@@ -1,3 +1,7 @@
+#include <cstdint>
+#include <mutex>
+
+#include <android/choreographer.h>
 #include <jni.h>
 
 //#include <game-activity/GameActivity.cpp>
@@ -6,8 +10,30 @@
 #include <game-activity/native_app_glue/android_native_app_glue.h>
 
 #include "AndroidOut.h"
+#include "FramePacer.h"
 #include "Renderer.h"
 
+namespace {
+	// The renderer as seen from the UI thread, which delivers input events through `filterEvent`.
+	std::mutex earlyInputMutex;
+	Renderer *earlyInputRenderer = nullptr;
+
+	// Main thread only.
+	bool isResumed = false;
+	FramePacer framePacer;
+	// Vsync callbacks are only requested while frames are being rendered, so an idle loop isn't woken up by them.
+	bool isVsyncCallbackPosted = false;
+
+	void onVsync(const std::int64_t frameTime, void*) {
+		framePacer.onVsync(frameTime);
+		isVsyncCallbackPosted = false;
+	}
+
+	void onRefreshRateChanged(const std::int64_t vsyncPeriod, void*) {
+		framePacer.setRefreshPeriod(vsyncPeriod);
+	}
+} // namespace
+
 extern "C" {
 
 //#include <game-activity/native_app_glue/android_native_app_glue.c>
@@ -25,6 +51,10 @@ void handleCommand(android_app *const appData, const int32_t command) {
 			// if you change the class here as a reinterpret_cast is dangerous this in the
 			// android_main function and the APP_CMD_TERM_WINDOW handler case.
 			appData->userData = new Renderer(appData);
+			{
+				const std::lock_guard<std::mutex> lock(earlyInputMutex);
+				earlyInputRenderer = reinterpret_cast<Renderer*>(appData->userData);
+			}
 			break;
 		case APP_CMD_TERM_WINDOW:
 			// The window is being destroyed. Use this to clean up your userData to avoid leaking
@@ -34,9 +64,23 @@ void handleCommand(android_app *const appData, const int32_t command) {
 			if (appData->userData) {
 				auto *renderer = reinterpret_cast<Renderer*>(appData->userData);
 				appData->userData = nullptr;
+				{
+					const std::lock_guard<std::mutex> lock(earlyInputMutex);
+					earlyInputRenderer = nullptr;
+				}
 				delete renderer;
 			}
 			break;
+		case APP_CMD_RESUME:
+			isResumed = true;
+			break;
+		case APP_CMD_PAUSE:
+			isResumed = false;
+#ifdef YUBINOBUTAI_PROFILER
+			// Leaving the app is the easiest thing to do mid-song, and the file can then be pulled.
+			if (appData->userData) reinterpret_cast<Renderer*>(appData->userData)->dumpProfile();
+#endif
+			break;
 	}
 }
 
@@ -45,14 +89,22 @@ void handleCommand(android_app *const appData, const int32_t command) {
  * passed back to OS for further processing. For this example case,
  * only pointer and joystick devices are enabled.
  *
+ * This runs on the UI thread as soon as the event arrives, so it also gives the renderer a chance to react before
+ * the event waits for the game loop.
+ *
  * @param motionEvent the newly arrived GameActivityMotionEvent.
  * @return true if the event is from a pointer or joystick device,
  *         false for all other input devices.
  */
 bool filterEvent(const GameActivityMotionEvent *const motionEvent) {
 	auto sourceClass = motionEvent->source & AINPUT_SOURCE_CLASS_MASK;
-	return sourceClass == AINPUT_SOURCE_CLASS_POINTER
+	const bool accepted = sourceClass == AINPUT_SOURCE_CLASS_POINTER
 		|| sourceClass == AINPUT_SOURCE_CLASS_JOYSTICK;
+	if (accepted) {
+		const std::lock_guard<std::mutex> lock(earlyInputMutex);
+		if (earlyInputRenderer) earlyInputRenderer->handleEarlyInput(*motionEvent);
+	}
+	return accepted;
 }
 
 /*!
@@ -70,18 +122,38 @@ void android_main(struct android_app *const appData) {
 	// implemented in android_native_app_glue.c.
 	android_app_set_motion_event_filter(appData, filterEvent);
 
-	// This sets up a typical game/event loop. It will run until the app is destroyed.
+	AChoreographer *const choreographer = AChoreographer_getInstance();
+	AChoreographer_registerRefreshRateCallback(choreographer, onRefreshRateChanged, nullptr);
+
+	// This sets up a typical game/event loop. It will run until the app is destroyed. While there is something to
+	// show, it waits for events until the frame pacer says the next frame is due; otherwise it sleeps until an event
+	// arrives.
 	int events;
 	android_poll_source *pollSource;
 	do {
-		if (ALooper_pollAll(0, nullptr, &events, reinterpret_cast<void**>(&pollSource)) >= 0) {
+		const bool isAnimating = appData->userData && isResumed;
+		if (isAnimating && !isVsyncCallbackPosted) {
+			AChoreographer_postFrameCallback64(choreographer, onVsync, nullptr);
+			isVsyncCallbackPosted = true;
+		}
+		const int timeout = isAnimating ? framePacer.getPollTimeout() : -1;
+		if (ALooper_pollAll(timeout, nullptr, &events, reinterpret_cast<void**>(&pollSource)) >= 0) {
 			if (pollSource) pollSource->process(appData, pollSource);
 		}
 
-		if (appData->userData) {
+		// An event may have come in before the frame is due.
+		if (appData->userData && isResumed && framePacer.getPollTimeout() == 0) {
 			auto &renderer = *reinterpret_cast<Renderer*>(appData->userData);
+			framePacer.beginFrame();
 			renderer.handleInput();
 			renderer.render();
+			framePacer.endFrame();
+			renderer.present();
+#ifdef YUBINOBUTAI_BENCHMARKS
+			if (framePacer.getFrameCount() % 1000 == 0) aout << "Frames: " << framePacer.getAverageFrameInterval()
+				<< " ms apart, " << framePacer.getAverageWorkTime() << " ms of work, "
+				<< framePacer.getLateFrameCount() << " late so far" << std::endl;
+#endif
 		}
 	} while (!appData->destroyRequested);
 }
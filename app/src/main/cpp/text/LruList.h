@@ -88,7 +88,7 @@ typename LruList<T>::Handle LruList<T>::add(const T data) {
 
 template<typename T>
 bool LruList<T>::isAlive(const Handle handle) {
-	return pool[handle.index] == handle.epoch;
+	return pool[handle.index].epoch == handle.epoch;
 }
 
 template<typename T>
@@ -98,7 +98,8 @@ bool LruList<T>::ping(const Handle handle) {
 	entry.lastUsed = currentEpoch;
 	if (handle.index == headIndex) return true;
 	pool[entry.previousIndex].nextIndex = entry.nextIndex;
-	if (handle.index != tailIndex) pool[entry.nextIndex].previousIndex = entry.previousIndex;
+	if (handle.index == tailIndex) tailIndex = entry.previousIndex;
+	else pool[entry.nextIndex].previousIndex = entry.previousIndex;
 	pool[headIndex].previousIndex = handle.index;
 	entry.previousIndex = handle.index;
 	entry.nextIndex = headIndex;
@@ -116,10 +117,11 @@ void LruList<T>::remove(const Handle handle) {
 		return;
 	}
 	if (handle.index == headIndex) {
+		headIndex = entry.nextIndex;
+		pool[headIndex].previousIndex = headIndex;
 		Entry &tail = pool[tailIndex];
 		entry.nextIndex = tail.nextIndex;
-		tail.nextIndex = headIndex;
-		headIndex = entry.nextIndex;
+		tail.nextIndex = handle.index;
 	} else if (handle.index == tailIndex) {
 		tailIndex = entry.previousIndex;
 	} else {
@@ -149,7 +151,7 @@ T* LruList<T>::getData(const Handle handle) {
 
 template<typename T>
 const T* LruList<T>::getData(const Handle handle) const {
-	Entry &entry = pool[handle.index];
+	const Entry &entry = pool[handle.index];
 	return entry.epoch == handle.epoch ? &entry.data : nullptr;
 }
 
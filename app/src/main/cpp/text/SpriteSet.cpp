@@ -2,6 +2,8 @@
 
 #include <GLES3/gl3.h>
 
+#include <Profiler.h>
+
 #include "SpriteSet.h"
 
 namespace {
@@ -52,6 +54,8 @@ SpriteSet::SpriteSet(const int spritePadding): spritePadding(spritePadding) {
 }
 
 void SpriteSet::tick() {
+	static const int zone = Profiler::addZone("Sprite compaction");
+	const Profiler::Scope scope(zone);
 	++currentEpoch;
 	lruList.tick();
 	if (
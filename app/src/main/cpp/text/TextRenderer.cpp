@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <cstdint>
 #include <memory>
@@ -14,6 +15,10 @@
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
+#include <CommandList.h>
+#include <FrameArena.h>
+#include <Profiler.h>
+#include <RenderQueue.h>
 #include "MemoryFont.h"
 #include "TextLayout.h"
 
@@ -54,12 +59,6 @@ void main() {
 }
 
 namespace {
-	struct Batch {
-		bool used;
-		unsigned textureId;
-		std::vector<float> data;
-	};
-
 	std::uint64_t makeGlyphKey(
 		const std::uint16_t fontId, const float size, const std::uint32_t glyphId,
 		const float offset
@@ -69,20 +68,29 @@ namespace {
 			| (static_cast<std::uint64_t>(glyphId) << 2)
 			| (static_cast<std::uint64_t>(offset * 4.f) & 0b11);
 	}
-
-	std::vector<Batch> batches;
 }
 
-TextRenderer::TextRenderer():
-	shader(std::move(Shader::loadShader(textVertexShaderSource, textFragmentShaderSource))),
+TextRenderer::TextRenderer(StreamingBuffer &streamingBuffer):
+	streamingBuffer(streamingBuffer),
+	shader(std::move(Shader::loadShader("TextRenderer", textVertexShaderSource, textFragmentShaderSource))),
 	spriteSet(1)
 {
 	const auto shaderProgram = shader->getProgram();
 	shader->activate();
 	shaderMatrixUniformIndex = glGetUniformLocation(shaderProgram, "projection");
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(1);
 	glEnableVertexAttribArray(2);
+	glBindVertexArray(0);
+}
+
+TextRenderer::~TextRenderer() {
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteBuffers(1, &indexBuffer);
 }
 
 void TextRenderer::tick() {
@@ -90,10 +98,14 @@ void TextRenderer::tick() {
 }
 
 void TextRenderer::syncToGpu() {
+	static const int zone = Profiler::addZone("Glyph upload");
+	const Profiler::Scope scope(zone);
 	spriteSet.syncToGpu();
 }
 
 void TextRenderer::prepareForRendering(const TextLayout &layout, const bool pixelPerfect) {
+	static const int zone = Profiler::addZone("Glyph rasterization");
+	const Profiler::Scope scope(zone);
 	const auto &text = layout.getText();
 	for (const auto &line : layout.getLines()) for (const auto &run : line.runs) {
 		const auto fontScale = static_cast<FT_F26Dot6>(run.size * 64.f);
@@ -118,7 +130,8 @@ void TextRenderer::prepareForRendering(const TextLayout &layout, const bool pixe
 			const auto &bitmapGlyph = *reinterpret_cast<FT_BitmapGlyph>(glyph);
 			const auto &bitmap = bitmapGlyph.bitmap;
 			const int xAdvance = bitmapGlyph.root.advance.x >> 10;
-			spriteMap.emplace(glyphKey, GlyphData{
+			// Replaces the entry of a sprite that was evicted.
+			spriteMap.insert_or_assign(glyphKey, GlyphData{
 				spriteSet.add(bitmap.width, bitmap.rows, bitmap.buffer),
 				bitmapGlyph.left, -bitmapGlyph.top, xAdvance
 			});
@@ -127,14 +140,20 @@ void TextRenderer::prepareForRendering(const TextLayout &layout, const bool pixe
 	}
 }
 
-void TextRenderer::renderText(const TextLayout &layout, const glm::mat4 &projectionMatrix, const bool pixelPerfect) {
-	const auto &text = layout.getText();
-	for (auto &batch : batches) {
-		if (!batch.used) break;
-		batch.used = false;
-		batch.data.clear();
-	}
-	auto currentBatch = batches.end();
+void TextRenderer::renderText(
+	CommandList &list, const TextLayout &layout, const glm::mat4 &projectionMatrix, const bool pixelPerfect
+) {
+	std::size_t maxQuadCount = 0;
+	for (const auto &line : layout.getLines()) for (const auto &run : line.runs) maxQuadCount += run.layout.nGlyphs();
+	if (maxQuadCount == 0) return;
+	// The quads are written in layout order first, then grouped by texture. All scratch comes from the list's arena,
+	// so recordings into different lists can run in parallel.
+	FrameArena &arena = list.getArena();
+	float *const quads = arena.allocateArray<float>(maxQuadCount * 32);
+	unsigned *const quadBatches = arena.allocateArray<unsigned>(maxQuadCount);
+	RecordedBatch *const recordedBatches = arena.allocateArray<RecordedBatch>(maxQuadCount);
+	RecordedText recordedText{this, projectionMatrix};
+	unsigned currentBatch = 0;
 	float currentY = 0.f;
 	for (const auto &line : layout.getLines()) {
 		const float lineY = currentY + line.ascent;
@@ -144,10 +163,15 @@ void TextRenderer::renderText(const TextLayout &layout, const glm::mat4 &project
 			const auto &runLayout = run.layout;
 			const std::size_t glyphCount = runLayout.nGlyphs();
 			for (std::size_t i = 0; i != glyphCount; ++i) {
-				const auto &glyphData = spriteMap[makeGlyphKey(
-					static_cast<std::uint16_t>(static_cast<MemoryFont&>(*runLayout.getFont(i)->baseTypeface()).id),
+				const auto glyphIterator = spriteMap.find(makeGlyphKey(
+					static_cast<std::uint16_t>(
+						static_cast<const MemoryFont&>(*runLayout.getFont(i)->baseTypeface()).id
+					),
 					run.size, runLayout.getGlyphId(i), pixelPerfect ? runLayout.getX(i) : 0.f
-				)];
+				));
+				// Only if the layout wasn't prepared.
+				if (glyphIterator == spriteMap.end()) continue;
+				const GlyphData &glyphData = glyphIterator->second;
 				const auto spriteData = spriteSet.get(glyphData.handle);
 				const float
 					characterX = currentX + glyphData.xOffset
@@ -172,27 +196,55 @@ void TextRenderer::renderText(const TextLayout &layout, const glm::mat4 &project
 					static_cast<float>(spriteData.x + spriteData.width), static_cast<float>(spriteData.y),
 					run.red, run.green, run.blue, run.alpha
 				};
-				if (currentBatch == batches.end() || currentBatch->textureId != spriteData.textureId) {
-					currentBatch = std::find_if(batches.begin(), batches.end(), [&spriteData](const auto &batch) {
-						return !batch.used || batch.textureId == spriteData.textureId;
-					});
-					if (currentBatch == batches.end()) {
-						batches.push_back({true, spriteData.textureId});
-						currentBatch = batches.end() - 1;
-					} else {
-						currentBatch->used = true;
+				if (
+					currentBatch == recordedText.batchCount
+					|| recordedBatches[currentBatch].textureId != spriteData.textureId
+				) {
+					currentBatch = 0;
+					while (
+						currentBatch != recordedText.batchCount
+						&& recordedBatches[currentBatch].textureId != spriteData.textureId
+					) ++currentBatch;
+					if (currentBatch == recordedText.batchCount) {
+						recordedBatches[currentBatch] = {spriteData.textureId, 0, 0};
+						++recordedText.batchCount;
 					}
 				}
-				currentBatch->data.insert(currentBatch->data.end(), vertexData, vertexData + 32);
+				std::copy(vertexData, vertexData + 32, quads + recordedText.quadCount * 32);
+				quadBatches[recordedText.quadCount] = currentBatch;
+				++recordedBatches[currentBatch].quadCount;
+				++recordedText.quadCount;
 			}
 			currentX += runLayout.getAdvance();
 		}
 	}
-	shader->activate();
-	glUniformMatrix4fv(shaderMatrixUniformIndex, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
-	for (const Batch &batch : batches) {
-		const unsigned quadCount = static_cast<unsigned>(batch.data.size()) / 32;
-		for (unsigned i = static_cast<unsigned>(renderIndices.size()) / 6; i != quadCount; ++i) {
+	if (recordedText.quadCount == 0) return;
+	float *const data = arena.allocateArray<float>(recordedText.quadCount * 32);
+	unsigned firstQuad = 0;
+	for (unsigned i = 0; i != recordedText.batchCount; ++i) {
+		RecordedBatch &batch = recordedBatches[i];
+		batch.firstQuad = firstQuad;
+		firstQuad += batch.quadCount;
+		// Counts back up as the quads are placed.
+		batch.quadCount = 0;
+	}
+	for (unsigned i = 0; i != recordedText.quadCount; ++i) {
+		RecordedBatch &batch = recordedBatches[quadBatches[i]];
+		std::copy(quads + i * 32, quads + (i + 1) * 32, data + (batch.firstQuad + batch.quadCount) * 32);
+		++batch.quadCount;
+	}
+	recordedText.data = data;
+	recordedText.batches = recordedBatches;
+	list.record<RecordedText, submitRecordedText>(recordedText);
+}
+
+void TextRenderer::submitRecordedText(const RecordedText &recordedText, RenderQueue &queue) {
+	TextRenderer &renderer = *recordedText.renderer;
+	auto &renderIndices = renderer.renderIndices;
+	if (renderIndices.size() / 6 < recordedText.quadCount) {
+		// The index buffer is bound through the vertex array.
+		queue.getStateCache().bindVertexArray(renderer.vertexArray);
+		for (unsigned i = static_cast<unsigned>(renderIndices.size()) / 6; i != recordedText.quadCount; ++i) {
 			const unsigned currentIndex = i * 4;
 			const unsigned newIndices[] = {
 				currentIndex, currentIndex + 1, currentIndex + 2,
@@ -200,13 +252,36 @@ void TextRenderer::renderText(const TextLayout &layout, const glm::mat4 &project
 			};
 			renderIndices.insert(renderIndices.end(), newIndices, newIndices + 6);
 		}
-		glBindTexture(GL_TEXTURE_2D, batch.textureId);
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8*sizeof(float), batch.data.data());
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8*sizeof(float), batch.data.data() + 2);
-		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8*sizeof(float), batch.data.data() + 4);
-		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(quadCount * 6), GL_UNSIGNED_INT, renderIndices.data());
+		glBufferData(
+			GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(renderIndices.size() * sizeof(unsigned)),
+			renderIndices.data(), GL_STATIC_DRAW
+		);
+	}
+	// All batches go into the buffer back to back under one attribute setup. Batches are whole quads, so each can
+	// draw its slice of the shared quad indices.
+	const auto writtenOffset = renderer.streamingBuffer.write(
+		recordedText.data, recordedText.quadCount * 32 * sizeof(float)
+	);
+	if (!writtenOffset) return;
+	const auto offset = static_cast<std::uintptr_t>(*writtenOffset);
+	const GLuint vertexBuffer = renderer.streamingBuffer.getBuffer();
+	constexpr GLsizei stride = 8 * sizeof(float);
+	for (unsigned i = 0; i != recordedText.batchCount; ++i) {
+		const RecordedBatch &batch = recordedText.batches[i];
+		RenderQueue::Draw draw{GL_TRIANGLES, static_cast<GLsizei>(batch.quadCount * 6), GL_UNSIGNED_INT};
+		draw.indexOffset = static_cast<std::uintptr_t>(batch.firstQuad) * 6 * sizeof(unsigned);
+		queue.add(
+			RenderQueue::Pass::Overlay, 0.f, renderer.shader->getProgram(), renderer.vertexArray, batch.textureId,
+			{{
+				renderer.shaderMatrixUniformIndex, GlStateCache::UniformType::Matrix4,
+				glm::value_ptr(recordedText.projectionMatrix)
+			}},
+			vertexBuffer,
+			{
+				{0, 2, stride, offset}, {1, 2, stride, offset + 2 * sizeof(float)},
+				{2, 4, stride, offset + 4 * sizeof(float)}
+			},
+			draw
+		);
 	}
 }
\ No newline at end of file
@@ -9,7 +9,10 @@
 
 #include <glm/glm.hpp>
 
+#include <CommandList.h>
+#include <RenderQueue.h>
 #include <Shader.h>
+#include <StreamingBuffer.h>
 #include "SpriteSet.h"
 #include "TextLayout.h"
 
@@ -19,21 +22,43 @@ class TextRenderer final {
 			SpriteSet::Handle handle;
 			int xOffset, yOffset, xAdvance;
 		};
+		struct RecordedBatch {
+			unsigned textureId, firstQuad, quadCount;
+		};
+		struct RecordedText {
+			TextRenderer *renderer;
+			glm::mat4 projectionMatrix;
+			unsigned quadCount = 0, batchCount = 0;
+			const float *data = nullptr;
+			const RecordedBatch *batches = nullptr;
+		};
 
+		StreamingBuffer &streamingBuffer;
 		std::unique_ptr<Shader> shader;
 		int shaderMatrixUniformIndex;
+		unsigned vertexArray = 0, indexBuffer = 0;
 
 		SpriteSet spriteSet;
 		std::unordered_map<std::uint64_t, GlyphData> spriteMap;
 		std::vector<unsigned> renderIndices;
+
+		static void submitRecordedText(const RecordedText &recordedText, RenderQueue &queue);
 	public:
-		TextRenderer();
+		explicit TextRenderer(StreamingBuffer &streamingBuffer);
+		TextRenderer(const TextRenderer&) = delete;
+		TextRenderer& operator=(const TextRenderer&) = delete;
+		~TextRenderer();
 		void tick();
 		void syncToGpu();
 		// Pixel perfect renders glyphs at their fractional horizontal offsets and places the rasterizations at
 		// integral pixel positions.
 		void prepareForRendering(const TextLayout &layout, bool pixelPerfect);
-		void renderText(const TextLayout &layout, const glm::mat4 &projectionMatrix, bool pixelPerfect);
+		// Records the draws into the list, `syncToGpu` has to come before the list is submitted. Only this may run off
+		// the GL thread, after the layout was prepared: the rest can create, fill and delete atlas textures. It only
+		// reads the glyphs and sprites, so several lists can be recorded at once.
+		void renderText(
+			CommandList &list, const TextLayout &layout, const glm::mat4 &projectionMatrix, bool pixelPerfect
+		);
 };
 
 #endif // TEXT_FONTRENDERER_H
\ No newline at end of file
@@ -0,0 +1,188 @@
+/*
+	Renders a fixed stretch of audio through the game's mixer the way the audio callback does, inside a real-time scope,
+	and checks the output samples against the tracks mixed by hand and against the real-time safety checker. Then checks
+	that streams taken out of the mixer are only destroyed once the audio thread can no longer be using them.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <android/asset_manager.h>
+
+#include <audio/AggregateAudioStream.h>
+#include <audio/AudioStream.h>
+#include <audio/AudioClock.h>
+#include <audio/DitheringConverter.h>
+#include <audio/MetronomeAudioStream.h>
+#include <audio/PreloadedAudioStream.h>
+#include <audio/PreloadedAudioTrack.h>
+#include <audio/RealtimeSafety.h>
+#include <audio/TriggeredAudioStream.h>
+#include "TestSupport.h"
+
+using TestSupport::check;
+
+namespace {
+	constexpr int callbackFrames = 256;
+	constexpr int callbackCount = 8;
+	constexpr int totalFrames = callbackFrames * callbackCount;
+	constexpr int triggerCallback = 2;
+
+	std::vector<std::int16_t> makeSamples(const int length, const int step) {
+		std::vector<std::int16_t> samples(length);
+		for (int i = 0; i != length; ++i) samples[i] = static_cast<std::int16_t>((i % 64 - 32) * step);
+		return samples;
+	}
+
+	// Endless silence. Can run an action from inside a callback, as if the controlling thread ran at that moment, and
+	// records when it is destroyed.
+	class ProbeStream final: public AudioStream {
+		private:
+			bool &isDestroyed;
+		public:
+			std::function<void()> action;
+
+			explicit ProbeStream(bool &isDestroyed): isDestroyed(isDestroyed) {
+				isDestroyed = false;
+			}
+			~ProbeStream() override {
+				isDestroyed = true;
+			}
+			int getAudio(float *&buffer, const int frameCount) override {
+				std::fill(buffer, buffer + frameCount * 2, 0.f);
+				if (action) std::exchange(action, nullptr)();
+				return frameCount;
+			}
+	};
+
+	void runCallback(AggregateAudioStream &mixer) {
+		float samples[callbackFrames * 2];
+		float *buffer = samples;
+		mixer.getAudio(buffer, callbackFrames);
+	}
+
+	void checkReclamation() {
+		// A playing owned stream stopped while a callback is in progress. That callback may have picked up the stream
+		// before the stop, so only the one after it proves the stream unused.
+		{
+			AggregateAudioStream mixer;
+			mixer.reserve(callbackFrames);
+			bool isProbeDestroyed, isOwnedDestroyed;
+			ProbeStream probe(isProbeDestroyed);
+			mixer.play(&probe);
+			const auto ownedHandle = mixer.play(std::make_unique<ProbeStream>(isOwnedDestroyed));
+			runCallback(mixer);
+			probe.action = [&]() {
+				mixer.stop(ownedHandle);
+			};
+			runCallback(mixer);
+			mixer.collectGarbage();
+			check(!isOwnedDestroyed, "a stream stopped during a callback outlives that callback");
+			runCallback(mixer);
+			check(!mixer.isPlaying(ownedHandle), "a stopped stream stops playing");
+			check(!isOwnedDestroyed, "a retired stream stays until garbage is collected");
+			mixer.collectGarbage();
+			check(isOwnedDestroyed, "a stopped stream is destroyed after the next callback");
+		}
+
+		// A borrowed stream, stopped and handed over between callbacks.
+		{
+			AggregateAudioStream mixer;
+			mixer.reserve(callbackFrames);
+			bool isDestroyed;
+			auto stream = std::make_unique<ProbeStream>(isDestroyed);
+			const auto handle = mixer.play(stream.get());
+			runCallback(mixer);
+			mixer.stop(handle);
+			mixer.retire(std::move(stream));
+			mixer.collectGarbage();
+			check(!isDestroyed, "a retired stream outlives the callbacks before it");
+			runCallback(mixer);
+			check(!isDestroyed, "callbacks don't destroy retired streams themselves");
+			mixer.collectGarbage();
+			check(isDestroyed, "a retired stream is destroyed once garbage is collected after the next callback");
+		}
+	}
+
+	void mixInto(std::vector<float> &output, const PreloadedAudioTrack &track, const int startFrame) {
+		const auto &data = track.getAudioData();
+		for (int i = 0; i != static_cast<int>(data.size()) && startFrame * 2 + i < static_cast<int>(output.size()); ++i)
+			output[startFrame * 2 + i] += data[i];
+	}
+} // namespace
+
+int main() {
+	AAssetManager assets;
+	assets.files["Click.wav"] = TestSupport::makeWav(makeSamples(100, 96));
+	assets.files["Hit.wav"] = TestSupport::makeWav(makeSamples(60, 160));
+	assets.files["Music.wav"] = TestSupport::makeWav(makeSamples(300, 64));
+	const PreloadedAudioTrack clickTrack(&assets, "Click.wav"), hitTrack(&assets, "Hit.wav");
+	PreloadedAudioTrack musicTrack(&assets, "Music.wav");
+	if (!check(clickTrack.getLength() == 100 && hitTrack.getLength() == 60, "test tracks load")) {
+		return TestSupport::finish();
+	}
+
+	MetronomeAudioStream metronome(clickTrack, 10., 3);
+	TriggeredAudioStream hits(hitTrack);
+	AggregateAudioStream mixer;
+	mixer.reserve(callbackFrames);
+	const auto metronomeHandle = mixer.play(&metronome);
+	mixer.play(&hits);
+	const auto musicHandle = mixer.play(std::make_unique<PreloadedAudioStream>(musicTrack));
+
+	// Without this, a clean run below would prove nothing. Reports the two violations on purpose.
+	const int initialViolationCount = RealtimeScope::getViolationCount();
+	{
+		const RealtimeScope realtimeScope;
+		void *volatile allocation = std::malloc(16);
+		std::free(allocation);
+	}
+	check(RealtimeScope::getViolationCount() == initialViolationCount + 2, "the checker sees allocations");
+
+	std::vector<float> output(totalFrames * 2);
+	std::vector<std::int16_t> convertedOutput(totalFrames * 2);
+	DitheringConverter ditheringConverter;
+	const int violationCount = RealtimeScope::getViolationCount();
+	for (int callback = 0; callback != callbackCount; ++callback) {
+		if (callback == triggerCallback) hits.trigger(AudioClock::now());
+		float *const originalBuffer = output.data() + callback * callbackFrames * 2;
+		float *buffer = originalBuffer;
+		int frameCount;
+		{
+			const RealtimeScope realtimeScope;
+			frameCount = mixer.getAudio(buffer, callbackFrames);
+			ditheringConverter.convert(
+				buffer, convertedOutput.data() + callback * callbackFrames * 2, callbackFrames * 2
+			);
+		}
+		check(frameCount == callbackFrames, "the mixer fills whole callbacks");
+		check(buffer == originalBuffer, "the mixer writes in place");
+	}
+	check(RealtimeScope::getViolationCount() == violationCount, "mixing is real-time safe");
+
+	std::vector<float> expectedOutput(totalFrames * 2);
+	for (int click = 0; click != 3; ++click) mixInto(expectedOutput, clickTrack, click * 480);
+	mixInto(expectedOutput, hitTrack, triggerCallback * callbackFrames);
+	mixInto(expectedOutput, musicTrack, 0);
+	int wrongSampleCount = 0, wrongConvertedSampleCount = 0;
+	for (int i = 0; i != totalFrames * 2; ++i) {
+		if (std::abs(output[i] - expectedOutput[i]) > 1e-6f) ++wrongSampleCount;
+		// Rounding and dither each move a sample by up to one step.
+		if (std::abs(convertedOutput[i] - expectedOutput[i] * 32767.f) > 2.f) ++wrongConvertedSampleCount;
+	}
+	check(wrongSampleCount == 0, std::to_string(wrongSampleCount) + " mixed samples are wrong");
+	check(wrongConvertedSampleCount == 0, std::to_string(wrongConvertedSampleCount) + " 16-bit samples are wrong");
+
+	check(!mixer.isPlaying(musicHandle), "finished streams stop playing");
+	check(mixer.isPlaying(metronomeHandle), "unfinished streams keep playing");
+
+	checkReclamation();
+	return TestSupport::finish();
+}
\ No newline at end of file
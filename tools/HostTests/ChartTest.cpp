@@ -0,0 +1,65 @@
+/*
+	Checks that charts the playfield couldn't scroll through are rejected when loaded.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Chart.h"
+#include "TestSupport.h"
+
+using TestSupport::check;
+
+namespace {
+	// Past the version 2 header, without extra columns.
+	constexpr std::size_t notesOffset = 20;
+
+	std::vector<unsigned char> convert(const std::string_view text) {
+		std::vector<unsigned char> data;
+		check(Chart::convertText(text.data(), text.size(), data), "the text chart converts");
+		return data;
+	}
+
+	void setSpeed(std::vector<unsigned char> &data, const std::size_t noteCount, const int index, const float speed) {
+		std::memcpy(data.data() + notesOffset + noteCount * 8 + index * 8 + 4, &speed, 4);
+	}
+} // namespace
+
+int main() {
+	const std::vector<unsigned char> data = convert("1000 0\n500 1\n2000 2\nspeed 1500 2\nspeed 0 1.5\n");
+	const auto chart = Chart::fromData(data);
+	check(chart && chart->getNoteCount() == 3 && chart->getSpeedChangeCount() == 2, "a valid chart loads");
+	check(chart && chart->getNotes()[0].time == 500 && chart->getSpeedChanges()[0].time == 0, "the text is sorted");
+
+	auto unsortedNotes = data;
+	// Swaps the times of the first two notes.
+	std::swap_ranges(
+		unsortedNotes.begin() + notesOffset, unsortedNotes.begin() + notesOffset + 4,
+		unsortedNotes.begin() + notesOffset + 8
+	);
+	check(!Chart::fromData(unsortedNotes), "notes out of order are rejected");
+
+	auto unsortedSpeedChanges = data;
+	std::swap_ranges(
+		unsortedSpeedChanges.begin() + notesOffset + 3 * 8, unsortedSpeedChanges.begin() + notesOffset + 3 * 8 + 4,
+		unsortedSpeedChanges.begin() + notesOffset + 4 * 8
+	);
+	check(!Chart::fromData(unsortedSpeedChanges), "speed changes out of order are rejected");
+
+	for (const float speed : {
+		std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), -1.f
+	}) {
+		auto badSpeed = data;
+		setSpeed(badSpeed, 3, 1, speed);
+		check(!Chart::fromData(badSpeed), "a speed of " + std::to_string(speed) + " is rejected");
+	}
+	auto stoppedSpeed = data;
+	setSpeed(stoppedSpeed, 3, 1, 0.f);
+	check(Chart::fromData(stoppedSpeed).has_value(), "a speed of 0 is accepted");
+	return TestSupport::finish();
+}
\ No newline at end of file
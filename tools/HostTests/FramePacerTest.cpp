@@ -0,0 +1,81 @@
+/*
+	Runs the frame pacer on a fake clock: how long the loop may sleep, which vsync each frame aims for and which frames
+	count as late.
+*/
+
+#include <cstdint>
+#include <string>
+
+#include "FramePacer.h"
+#include "TestSupport.h"
+
+using TestSupport::check;
+
+namespace {
+	constexpr std::int64_t millisecond = 1'000'000;
+	constexpr std::int64_t period = 16'666'667;
+	constexpr std::int64_t firstVsync = 1'000 * millisecond;
+
+	std::int64_t currentTime = 0;
+
+	std::int64_t fakeClock() {
+		return currentTime;
+	}
+
+	void runFrame(FramePacer &pacer, const std::int64_t startTime, const std::int64_t workTime) {
+		currentTime = startTime;
+		pacer.beginFrame();
+		currentTime += workTime;
+		pacer.endFrame();
+	}
+} // namespace
+
+int main() {
+	FramePacer pacer(fakeClock);
+	pacer.setRefreshPeriod(period);
+	currentTime = firstVsync - 5 * millisecond;
+	check(pacer.getPollTimeout() == 0, "without vsyncs the loop doesn't wait");
+
+	pacer.onVsync(firstVsync);
+	currentTime = firstVsync + millisecond;
+	// Nothing measured yet, so the frame starts a margin before the next vsync.
+	check(
+		pacer.getPollTimeout() == static_cast<int>((period - FramePacer::margin - millisecond) / millisecond),
+		"the first frame waits until a margin before the next vsync"
+	);
+	runFrame(pacer, firstVsync + 14 * millisecond, 4 * millisecond);
+	check(pacer.getTargetVsyncTime() == firstVsync + period, "the first frame aims for the next vsync");
+
+	// With 4 ms of work measured, the next frame starts that much earlier, and aims past the vsync already taken.
+	pacer.onVsync(firstVsync + period);
+	currentTime = firstVsync + 18 * millisecond;
+	const std::int64_t startTime = firstVsync + 2 * period - 4 * millisecond - FramePacer::margin;
+	check(
+		pacer.getPollTimeout() == static_cast<int>((startTime - currentTime) / millisecond),
+		"the wait leaves room for the measured work, got " + std::to_string(pacer.getPollTimeout())
+	);
+	runFrame(pacer, firstVsync + 27 * millisecond, 4 * millisecond);
+	check(pacer.getTargetVsyncTime() == firstVsync + 2 * period, "the second frame aims for the vsync after");
+	check(pacer.getLateFrameCount() == 0, "frames a period apart aren't late");
+
+	// A frame starting too late for the next vsync aims for the one after, and counts as late.
+	pacer.onVsync(firstVsync + 2 * period);
+	currentTime = firstVsync + 60 * millisecond;
+	check(pacer.getPollTimeout() == 0, "a late frame starts right away");
+	runFrame(pacer, currentTime, 4 * millisecond);
+	check(pacer.getTargetVsyncTime() == firstVsync + 4 * period, "a late frame skips the vsync it can't make");
+	check(pacer.getLateFrameCount() == 1, "a frame two periods after the last is late");
+	// Two frames never aim for the same vsync.
+	runFrame(pacer, currentTime, millisecond);
+	check(pacer.getTargetVsyncTime() == firstVsync + 5 * period, "a frame right after aims one vsync later");
+	check(pacer.getLateFrameCount() == 1 && pacer.getFrameCount() == 4, "the frames are counted");
+
+	// Without a period from the display, it's estimated from single intervals between vsyncs.
+	FramePacer estimatingPacer(fakeClock);
+	estimatingPacer.onVsync(firstVsync);
+	estimatingPacer.onVsync(firstVsync + 16 * millisecond);
+	check(estimatingPacer.getRefreshPeriod() == 16 * millisecond, "the period is measured from vsyncs");
+	estimatingPacer.onVsync(firstVsync + 48 * millisecond);
+	check(estimatingPacer.getRefreshPeriod() == 16 * millisecond, "skipped vsyncs don't count");
+	return TestSupport::finish();
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+/*
+	Checks LruList against a plain list doing the same operations, including removals at either end and growth past
+	the initial pool.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <text/LruList.h>
+#include "TestSupport.h"
+
+using TestSupport::check;
+
+namespace {
+	// Most recently used first, like the list's head.
+	using Model = std::list<std::pair<int, LruList<int>::Handle>>;
+
+	bool matches(const LruList<int> &list, const Model &model) {
+		const int *const last = list.getLast();
+		if (model.empty()) return last == nullptr;
+		if (last == nullptr || *last != model.back().first) return false;
+		return std::all_of(model.begin(), model.end(), [&](const auto &entry) {
+			const int *const data = list.getData(entry.second);
+			return data != nullptr && *data == entry.first;
+		});
+	}
+} // namespace
+
+int main() {
+	{
+		LruList<int> list;
+		list.add(1);
+		list.add(2);
+		const auto third = list.add(3);
+		list.remove(third);
+		check(list.getLast() != nullptr && *list.getLast() == 1, "removing the head keeps the last entry");
+		list.evictLast();
+		list.evictLast();
+		check(list.getLast() == nullptr, "evicting everything empties the list");
+		const auto fourth = list.add(4);
+		check(list.getLast() != nullptr && *list.getLast() == 4, "the list is usable after removing its head");
+		check(!list.isAlive(third) && list.isAlive(fourth), "removed entries are dead");
+	}
+
+	LruList<int> list;
+	Model model;
+	std::mt19937 random(1234);
+	int nextValue = 0;
+	std::size_t maxSize = 0;
+	for (int step = 0; step != 20000; ++step) {
+		const auto operation = random() % 8;
+		if (operation < 4 || model.empty()) {
+			// Keeps growing on average, so the pool has to resize.
+			model.emplace_front(nextValue, list.add(nextValue));
+			++nextValue;
+		} else {
+			auto iterator = std::next(model.begin(), random() % model.size());
+			if (operation == 4) {
+				list.remove(iterator->second);
+				model.erase(iterator);
+			} else if (operation == 5) {
+				// Removing an end is where the bookkeeping is special.
+				iterator = random() % 2 == 0 ? model.begin() : std::prev(model.end());
+				list.remove(iterator->second);
+				model.erase(iterator);
+			} else if (operation == 6) {
+				list.ping(iterator->second);
+				model.splice(model.begin(), model, iterator);
+			} else {
+				list.evictLast();
+				model.pop_back();
+			}
+		}
+		maxSize = std::max(maxSize, model.size());
+		if (!check(matches(list, model), "the list matches the model at step " + std::to_string(step))) break;
+	}
+	check(maxSize > 1 << 10, "the pool grew");
+	return TestSupport::finish();
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*
+	Checks that replays read back exactly what was written, pointer IDs, positions and recorded judgements included,
+	and that older versions still read.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Replay.h"
+#include "TestSupport.h"
+
+using TestSupport::check;
+
+int main() {
+	const std::vector<ReplayEvent> events = {
+		{ReplayEvent::Type::Press, 0, 2, 1'000'000, 540, 1800},
+		{ReplayEvent::Type::Press, 30, 5, 1'000'500, 1079, 2399},
+		{ReplayEvent::Type::Press, 31, -1, 999'000, -3, 0},
+		{ReplayEvent::Type::Move, 40, 3, 1'200'000, 700, 1750},
+		{ReplayEvent::Type::Release, 1000, -1, 1'300'000, 701, 1700},
+		{ReplayEvent::Type::ReleaseAll, -1, -1, 1'400'000},
+		{ReplayEvent::Type::Advance, -1, -1, 5'000'000}
+	};
+	const std::vector<bool> hitNotes = {true, false, false, true, true, false, true, false, true};
+	ReplayWriter writer(hitNotes.size());
+	for (const auto &event : events) writer.add(event);
+	writer.addJudgements(hitNotes);
+
+	const auto &data = writer.getData();
+	ReplayReader reader(data.data(), data.size());
+	check(reader.isGood() && reader.getNoteCount() == hitNotes.size(), "the header reads back");
+	std::size_t eventCount = 0;
+	ReplayEvent event;
+	while (reader.next(event)) {
+		if (eventCount < events.size()) {
+			const auto &expected = events[eventCount];
+			check(
+				event.type == expected.type && event.pointerId == expected.pointerId
+					&& event.column == expected.column && event.time == expected.time
+					&& event.x == expected.x && event.y == expected.y,
+				"event " + std::to_string(eventCount) + " reads back"
+			);
+		}
+		++eventCount;
+	}
+	check(eventCount == events.size(), "every event reads back");
+	check(reader.hasJudgements() && reader.getHitNotes() == hitNotes, "the judgements read back");
+
+	// Cut off in the middle of the judgements.
+	ReplayReader truncatedReader(data.data(), data.size() - 1);
+	while (truncatedReader.next(event)) {}
+	check(!truncatedReader.hasJudgements(), "truncated judgements are rejected");
+
+	// Events without a pointer take the header byte and the time only.
+	ReplayWriter pointerlessWriter(0);
+	const std::size_t emptySize = pointerlessWriter.getData().size();
+	pointerlessWriter.add({ReplayEvent::Type::Advance, -1, -1, 10});
+	pointerlessWriter.add({ReplayEvent::Type::ReleaseAll, -1, -1, 50});
+	check(pointerlessWriter.getData().size() == emptySize + 4, "events without a pointer take 2 bytes");
+
+	// Version 2 escaped the missing pointer ID and had no positions.
+	const std::vector<unsigned char> version2Data = {
+		'Y', 'N', 'R', 'P', 2, 0, 0, 0, 0, 0, 0, 0,
+		// A press by pointer 1 in column 2, 10 µs in.
+		0 | 1 << 3, 20, 3,
+		// Advancing, pointer ID -1 escaped.
+		4 | 31 << 3, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 40
+	};
+	ReplayReader version2Reader(version2Data.data(), version2Data.size());
+	check(
+		version2Reader.next(event) && event.type == ReplayEvent::Type::Press && event.pointerId == 1
+			&& event.column == 2 && event.time == 10 && event.x == 0 && event.y == 0,
+		"a version 2 press reads back"
+	);
+	check(
+		version2Reader.next(event) && event.type == ReplayEvent::Type::Advance && event.pointerId == -1
+			&& event.time == 30 && !version2Reader.next(event),
+		"a version 2 advance reads back"
+	);
+	return TestSupport::finish();
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+	Checks which samples SampleBank keeps and evicts against its memory budget.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <android/asset_manager.h>
+
+#include <audio/SampleBank.h>
+#include "TestSupport.h"
+
+using TestSupport::check;
+
+namespace {
+	constexpr int sampleLength = 1000;
+	// Decoded to stereo floats.
+	constexpr std::size_t sampleSize = sampleLength * 2 * sizeof(float);
+
+	std::vector<unsigned char> makeSample(const std::int16_t value) {
+		return TestSupport::makeWav(std::vector<std::int16_t>(sampleLength, value));
+	}
+} // namespace
+
+int main() {
+	AAssetManager assets;
+	assets.files["A.wav"] = makeSample(100);
+	assets.files["B.wav"] = makeSample(200);
+	assets.files["C.wav"] = makeSample(300);
+	assets.files["D.wav"] = makeSample(400);
+	assets.files["Copy of A.wav"] = makeSample(100);
+	SampleBank bank(&assets, sampleSize * 5 / 2);
+
+	auto a = bank.load("A.wav"), b = bank.load("B.wav");
+	check(a && b && a->getLength() == sampleLength, "samples load");
+	check(!bank.load("Missing.wav"), "missing samples give an empty handle");
+	{
+		const auto copy = bank.load("Copy of A.wav");
+		check(&*copy == &*a && bank.getMemoryUsage() == sampleSize * 2, "identical files share a sample");
+	}
+
+	// Taking the most recently released sample back out of the unused ones.
+	b = {};
+	b = bank.load("B.wav");
+	auto c = bank.load("C.wav");
+	check(bank.getMemoryUsage() == sampleSize * 3, "samples in use stay even over the budget");
+
+	a = {};
+	check(bank.getMemoryUsage() == sampleSize * 2, "released samples are evicted when over the budget");
+	c = {};
+	check(bank.getMemoryUsage() == sampleSize * 2, "released samples are kept within the budget");
+
+	auto d = bank.load("D.wav");
+	check(bank.getMemoryUsage() == sampleSize * 2, "unused samples make room for new ones");
+	check(b && b->getLength() == sampleLength && b->getAudioData()[0] == 200.f / 32768.f, "samples in use survive");
+
+	c = bank.load("C.wav");
+	check(bank.getMemoryUsage() == sampleSize * 3 && c, "evicted samples load again");
+	return TestSupport::finish();
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef STUBS_ANDROID_ASSET_MANAGER_H
+#define STUBS_ANDROID_ASSET_MANAGER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+	Stands in for the NDK's asset manager on the desktop, with the assets held in memory. Only the calls the tested
+	code makes are there.
+*/
+
+struct AAssetManager {
+	std::unordered_map<std::string, std::vector<unsigned char>> files;
+};
+
+struct AAsset {
+	const std::vector<unsigned char> *data;
+};
+
+enum {
+	AASSET_MODE_UNKNOWN = 0,
+	AASSET_MODE_RANDOM = 1,
+	AASSET_MODE_STREAMING = 2,
+	AASSET_MODE_BUFFER = 3
+};
+
+inline AAsset* AAssetManager_open(AAssetManager *const assetManager, const char *const name, int) {
+	const auto iterator = assetManager->files.find(name);
+	return iterator == assetManager->files.end() ? nullptr : new AAsset{&iterator->second};
+}
+
+inline const void* AAsset_getBuffer(AAsset *const asset) {
+	return asset->data->data();
+}
+
+inline std::int64_t AAsset_getLength64(AAsset *const asset) {
+	return static_cast<std::int64_t>(asset->data->size());
+}
+
+inline void AAsset_close(AAsset *const asset) {
+	delete asset;
+}
+
+#endif // STUBS_ANDROID_ASSET_MANAGER_H
\ No newline at end of file
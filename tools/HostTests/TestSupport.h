@@ -0,0 +1,54 @@
+#ifndef HOSTTESTS_TESTSUPPORT_H
+#define HOSTTESTS_TESTSUPPORT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TestSupport {
+	inline int failureCount = 0;
+
+	// Reports a failed expectation and lets the test go on, `finish` then gives the exit status.
+	inline bool check(const bool condition, const std::string &description) {
+		if (!condition) {
+			std::fprintf(stderr, "FAILED: %s\n", description.c_str());
+			++failureCount;
+		}
+		return condition;
+	}
+
+	inline int finish() {
+		if (failureCount != 0) std::fprintf(stderr, "%d checks failed.\n", failureCount);
+		return failureCount == 0 ? 0 : 1;
+	}
+
+	// A 48 kHz 16-bit mono WAV file.
+	inline std::vector<unsigned char> makeWav(const std::vector<std::int16_t> &samples) {
+		const auto dataSize = static_cast<std::uint32_t>(samples.size() * 2);
+		std::vector<unsigned char> data;
+		const auto appendTag = [&](const char *const tag) {
+			for (int i = 0; i != 4; ++i) data.push_back(static_cast<unsigned char>(tag[i]));
+		};
+		const auto appendUint = [&](const std::uint32_t value, const int byteCount) {
+			for (int i = 0; i != byteCount; ++i) data.push_back(static_cast<unsigned char>(value >> (i * 8)));
+		};
+		appendTag("RIFF");
+		appendUint(36 + dataSize, 4);
+		appendTag("WAVE");
+		appendTag("fmt ");
+		appendUint(16, 4);
+		appendUint(1, 2); // PCM
+		appendUint(1, 2); // Channels
+		appendUint(48000, 4);
+		appendUint(48000 * 2, 4); // Bytes per second
+		appendUint(2, 2); // Bytes per frame
+		appendUint(16, 2); // Bits per sample
+		appendTag("data");
+		appendUint(dataSize, 4);
+		for (const std::int16_t sample : samples) appendUint(static_cast<std::uint16_t>(sample), 2);
+		return data;
+	}
+}
+
+#endif // HOSTTESTS_TESTSUPPORT_H
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <memory>
+#include <string>
+
+#include <android/asset_manager.h>
+
+#include <audio/PreloadedAudioTrack.h>
+#include <audio/WavDecoder.h>
+
+// Replaces the game's `PreloadedAudioTrack.cpp`, which falls back to FFmpeg. The tests only load WAV files, so
+// everything else loads as silence.
+
+PreloadedAudioTrack::PreloadedAudioTrack(AAssetManager *const assetManager, const std::string &name, bool) {
+	if (!tryLoadWav(assetManager, name)) decode(assetManager, name);
+	length = static_cast<int>(audioData.size()) / 2;
+}
+
+bool PreloadedAudioTrack::tryLoadWav(AAssetManager *const assetManager, const std::string &name) {
+	const std::unique_ptr<AAsset, void(*)(AAsset*)> asset(
+		AAssetManager_open(assetManager, name.c_str(), AASSET_MODE_BUFFER), AAsset_close
+	);
+	if (asset == nullptr) return false;
+	const void *const data = AAsset_getBuffer(asset.get());
+	return data != nullptr
+		&& WavDecoder::decode(data, static_cast<std::size_t>(AAsset_getLength64(asset.get())), audioData);
+}
+
+void PreloadedAudioTrack::decode(AAssetManager*, const std::string&) {}
\ No newline at end of file
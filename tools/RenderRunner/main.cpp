@@ -0,0 +1,276 @@
+/*
+	Draws the playfield the same way the game does, without a device or a GPU, to catch changes in what is drawn and
+	in what drawing it costs.
+
+	Usage: renderrunner <chart> <start time> <end time> <frame count> [<golden directory> [--update]]
+
+	The frames are spread evenly over the song time range, in milliseconds, with every note left unhit. They are drawn
+	offscreen through a surfaceless EGL context, so Mesa's software rasterizer does (`LIBGL_ALWAYS_SOFTWARE=1` forces
+	it). With a golden directory, each frame is compared against `frame-<index>.ppm` there, or saved there with
+	`--update`. Prints the CPU time and GL calls of each frame, then the totals. Fails if any frame differs from its
+	golden image.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+
+#include "Chart.h"
+#include "CommandList.h"
+#include "LineBatch.h"
+#include "Playfield.h"
+#include "RenderQueue.h"
+#include "StreamingBuffer.h"
+#include "Utility.h"
+
+namespace {
+	// Half of a common phone screen.
+	constexpr int width = 540, height = 1200;
+	// Rasterizers may differ slightly on edges between versions, so small differences on a few pixels are let through.
+	constexpr int channelTolerance = 4;
+	constexpr int maxDifferingPixels = width * height / 1000;
+
+	bool readFile(const char *const path, std::vector<unsigned char> &data) {
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream) return false;
+		data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	std::optional<Chart> loadChart(const char *const path) {
+		if (auto chart = Chart::fromFile(path)) return chart;
+		std::vector<unsigned char> text, data;
+		if (!readFile(path, text)) return std::nullopt;
+		if (!Chart::convertText(reinterpret_cast<const char*>(text.data()), text.size(), data)) return std::nullopt;
+		return Chart::fromData(std::move(data));
+	}
+
+	// Needs no window system at all where Mesa's surfaceless platform is there.
+	EGLDisplay getDisplay() {
+		if (Utility::hasExtension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS), "EGL_MESA_platform_surfaceless")) {
+			const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+				eglGetProcAddress("eglGetPlatformDisplayEXT")
+			);
+			if (getPlatformDisplay) {
+				return getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			}
+		}
+		return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	// Makes an OpenGL ES 3 context current. Drawing goes to a framebuffer object, the surface is only there when the
+	// context can't go without one.
+	bool createContext(EGLDisplay &display, EGLSurface &surface, EGLContext &context) {
+		display = getDisplay();
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) return false;
+		const bool isSurfaceless = Utility::hasExtension(
+			eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"
+		);
+		const EGLint configAttributes[] = {
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+			EGL_SURFACE_TYPE, isSurfaceless ? 0 : EGL_PBUFFER_BIT,
+			EGL_NONE
+		};
+		EGLConfig config;
+		EGLint configCount = 0;
+		if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) return false;
+		eglBindAPI(EGL_OPENGL_ES_API);
+		const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_NONE};
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+		if (context == EGL_NO_CONTEXT) return false;
+		surface = EGL_NO_SURFACE;
+		if (!isSurfaceless) {
+			const EGLint surfaceAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+			surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+			if (surface == EGL_NO_SURFACE) return false;
+		}
+		return eglMakeCurrent(display, surface, surface, context);
+	}
+
+	// Pixels are RGB, top row first.
+	void writeImage(const std::string &path, const std::vector<unsigned char> &pixels) {
+		std::ofstream stream(path, std::ios::binary);
+		stream << "P6\n" << width << ' ' << height << "\n255\n";
+		stream.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+	}
+
+	bool readImage(const std::string &path, std::vector<unsigned char> &pixels) {
+		std::ifstream stream(path, std::ios::binary);
+		std::string magic;
+		int imageWidth, imageHeight, maxValue;
+		stream >> magic >> imageWidth >> imageHeight >> maxValue;
+		if (!stream || magic != "P6" || imageWidth != width || imageHeight != height || maxValue != 255) return false;
+		stream.get();
+		pixels.resize(static_cast<std::size_t>(width) * height * 3);
+		stream.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+		return static_cast<bool>(stream);
+	}
+
+	void readPixels(std::vector<unsigned char> &pixels) {
+		std::vector<unsigned char> rgba(static_cast<std::size_t>(width) * height * 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+		pixels.resize(static_cast<std::size_t>(width) * height * 3);
+		// GL's first row is the bottom one.
+		for (int y = 0; y != height; ++y) for (int x = 0; x != width; ++x) {
+			const unsigned char *const source = &rgba[(static_cast<std::size_t>(height - 1 - y) * width + x) * 4];
+			std::copy(source, source + 3, &pixels[(static_cast<std::size_t>(y) * width + x) * 3]);
+		}
+	}
+
+	int countDifferingPixels(const std::vector<unsigned char> &first, const std::vector<unsigned char> &second) {
+		int count = 0;
+		for (std::size_t i = 0; i != first.size(); i += 3) {
+			for (int channel = 0; channel != 3; ++channel) {
+				if (std::abs(first[i + channel] - second[i + channel]) > channelTolerance) {
+					++count;
+					break;
+				}
+			}
+		}
+		return count;
+	}
+} // namespace
+
+int main(const int argumentCount, const char *const *const arguments) {
+	if (argumentCount < 5 || argumentCount > 7 || (argumentCount == 7 && std::strcmp(arguments[6], "--update") != 0)) {
+		std::fprintf(
+			stderr, "Usage: %s <chart> <start time> <end time> <frame count> [<golden directory> [--update]]\n",
+			arguments[0]
+		);
+		return 2;
+	}
+	const auto chart = loadChart(arguments[1]);
+	if (!chart) {
+		std::fprintf(stderr, "Couldn't load the chart %s.\n", arguments[1]);
+		return 1;
+	}
+	const double startTime = std::atof(arguments[2]), endTime = std::atof(arguments[3]);
+	const int frameCount = std::atoi(arguments[4]);
+	if (frameCount < 1 || endTime < startTime) {
+		std::fprintf(stderr, "The time range must go forward and have at least a frame.\n");
+		return 2;
+	}
+	const std::string goldenDirectory = argumentCount >= 6 ? arguments[5] : "";
+	const bool isUpdating = argumentCount == 7;
+
+	EGLDisplay display;
+	EGLSurface surface;
+	EGLContext context;
+	if (!createContext(display, surface, context)) {
+		std::fprintf(stderr, "Couldn't create an OpenGL ES 3 context, EGL error 0x%x.\n", eglGetError());
+		return 1;
+	}
+	std::fprintf(
+		stderr, "Rendering with %s, %s.\n",
+		reinterpret_cast<const char*>(glGetString(GL_RENDERER)), reinterpret_cast<const char*>(glGetString(GL_VERSION))
+	);
+	GLuint renderbuffer, framebuffer;
+	glGenRenderbuffers(1, &renderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+	glViewport(0, 0, width, height);
+	// The same as the game's.
+	glClearColor(0.f, 0.f, 0.f, 1.f);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDisable(GL_CULL_FACE);
+
+	int failureCount = 0;
+	{
+		const Playfield playfield(*chart);
+		StreamingBuffer streamingBuffer;
+		LineBatch lineBatch(streamingBuffer);
+		RenderQueue renderQueue;
+		CommandList commands;
+		const std::vector<bool> hitNotes(chart->getNoteCount());
+		Playfield::View view;
+		view.camera = Playfield::getCamera(static_cast<float>(width), static_cast<float>(height));
+		view.hitNotes = &hitNotes;
+		std::size_t timingCursor = 0;
+
+		double totalTime = 0., worstTime = 0.;
+		std::vector<unsigned char> pixels, goldenPixels;
+		std::printf("frame\ttime\tCPU time\tdraws\tstate calls\tdiffering pixels\n");
+		for (int frame = 0; frame != frameCount; ++frame) {
+			const double time = frameCount == 1 ? startTime
+				: startTime + (endTime - startTime) * frame / (frameCount - 1);
+			const long previousDrawCount = renderQueue.getDrawCount();
+			const auto previousStats = renderQueue.getStateCache().getStats();
+
+			// What the render thread does for the playfield, minus waiting for the workers. Finishing counts the
+			// rasterization in too, which the software rasterizer does on the CPU.
+			const auto start = std::chrono::steady_clock::now();
+			glClear(GL_COLOR_BUFFER_BIT);
+			view.distance = playfield.getTimingMap().getDistance(time, timingCursor);
+			playfield.advanceFirstNote(view.firstNote, time);
+			playfield.record(commands, lineBatch, view);
+			commands.submit(renderQueue);
+			renderQueue.submit();
+			streamingBuffer.endFrame();
+			commands.reset();
+			glFinish();
+			const double frameTime = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start
+			).count();
+			totalTime += frameTime;
+			worstTime = std::max(worstTime, frameTime);
+
+			const auto &stats = renderQueue.getStateCache().getStats();
+			std::printf(
+				"%d\t%.1f\t%.3f\t%ld\t%ld", frame, time, frameTime, renderQueue.getDrawCount() - previousDrawCount,
+				stats.issuedCalls - previousStats.issuedCalls
+			);
+			if (goldenDirectory.empty()) {
+				std::printf("\n");
+				continue;
+			}
+			readPixels(pixels);
+			char name[32];
+			std::snprintf(name, sizeof(name), "/frame-%04d.ppm", frame);
+			const std::string goldenPath = goldenDirectory + name;
+			if (isUpdating) {
+				writeImage(goldenPath, pixels);
+				std::printf("\tupdated\n");
+			} else if (!readImage(goldenPath, goldenPixels)) {
+				std::printf("\tno golden image\n");
+				++failureCount;
+			} else {
+				const int differingPixelCount = countDifferingPixels(pixels, goldenPixels);
+				std::printf("\t%d\n", differingPixelCount);
+				if (differingPixelCount > maxDifferingPixels) {
+					// Saved next to the golden image for a look at what changed.
+					writeImage(goldenPath + ".actual.ppm", pixels);
+					++failureCount;
+				}
+			}
+		}
+		std::fprintf(
+			stderr, "Rendered %d frames: %.3f ms of CPU time on average, %.3f ms at worst, %.1f draws per frame.\n",
+			frameCount, totalTime / frameCount, worstTime,
+			static_cast<double>(renderQueue.getDrawCount()) / frameCount
+		);
+		if (failureCount != 0) std::fprintf(stderr, "%d frames differ from their golden images.\n", failureCount);
+	}
+
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &renderbuffer);
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+	eglDestroyContext(display, context);
+	eglTerminate(display);
+	return failureCount == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+/*
+	Runs the game's judgement over recorded replays without a device.
+
+	Usage: replayrunner <chart> <replay>...
+
+	The chart is either a binary chart or a text one. Replays are what the game saves as `replay.ynr` in its internal
+	storage. Prints one line per replay with the score and hit error statistics, then the overall throughput. Fails if a
+	replay doesn't give the same hits as when it was recorded.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Chart.h"
+#include "JudgementState.h"
+#include "Replay.h"
+
+namespace {
+	bool readFile(const char *const path, std::vector<unsigned char> &data) {
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream) return false;
+		data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	std::optional<Chart> loadChart(const char *const path) {
+		if (auto chart = Chart::fromFile(path)) return chart;
+		std::vector<unsigned char> text, data;
+		if (!readFile(path, text)) return std::nullopt;
+		if (!Chart::convertText(reinterpret_cast<const char*>(text.data()), text.size(), data)) return std::nullopt;
+		return Chart::fromData(std::move(data));
+	}
+} // namespace
+
+int main(const int argumentCount, const char *const *const arguments) {
+	if (argumentCount < 3) {
+		std::fprintf(stderr, "Usage: %s <chart> <replay>...\n", arguments[0]);
+		return 2;
+	}
+	const auto chart = loadChart(arguments[1]);
+	if (!chart) {
+		std::fprintf(stderr, "Couldn't load the chart %s.\n", arguments[1]);
+		return 1;
+	}
+
+	int failureCount = 0, replayCount = 0;
+	std::vector<unsigned char> data;
+	double totalTime = 0.;
+	std::printf("replay\thits\tmisses\tmean error\tstandard deviation\tearliest\tlatest\n");
+	for (int i = 2; i != argumentCount; ++i) {
+		if (!readFile(arguments[i], data)) {
+			std::fprintf(stderr, "Couldn't read %s.\n", arguments[i]);
+			++failureCount;
+			continue;
+		}
+		const auto start = std::chrono::steady_clock::now();
+		ReplayReader reader(data.data(), data.size());
+		if (!reader.isGood() || reader.getNoteCount() != chart->getNoteCount()) {
+			std::fprintf(stderr, "%s is not a replay of this chart.\n", arguments[i]);
+			++failureCount;
+			continue;
+		}
+		JudgementState state(chart->getNotes(), chart->getNoteCount());
+		ReplayEvent event;
+		while (reader.next(event)) state.apply(event);
+		state.finish();
+		totalTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		++replayCount;
+
+		const auto &judgementIndex = state.getJudgementIndex();
+		const auto &errors = state.getErrorStatistics();
+		std::printf(
+			"%s\t%d\t%d\t%.3f\t%.3f\t%.3f\t%.3f\n", arguments[i],
+			judgementIndex.getHitCount(), judgementIndex.getMissCount(),
+			errors.getMean(), errors.getStandardDeviation(), errors.min, errors.max
+		);
+		// Older replays don't have them.
+		if (reader.hasJudgements()) {
+			const auto &hitNotes = judgementIndex.getHitNotes(), &recordedHitNotes = reader.getHitNotes();
+			const auto mismatch = std::mismatch(hitNotes.begin(), hitNotes.end(), recordedHitNotes.begin());
+			if (mismatch.first != hitNotes.end()) {
+				std::fprintf(
+					stderr, "%s diverges from the recorded play at note %td.\n", arguments[i],
+					mismatch.first - hitNotes.begin()
+				);
+				++failureCount;
+			}
+		}
+	}
+	if (replayCount != 0) std::fprintf(
+		stderr, "Judged %d replays in %.3f ms, %.0f replays per second.\n",
+		replayCount, totalTime * 1000., replayCount / totalTime
+	);
+	return failureCount == 0 ? 0 : 1;
+}
\ No newline at end of file